@@ -0,0 +1,522 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Checker Implementation File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the implementation for a class which validates a transaction file in
+  a single pass, tracking only names and group membership.
+*/
+
+#include "checker.h"
+#include "loader.h"
+#include "recurrence.h"
+
+#include <fstream>
+#include <cstdlib>
+
+//Size of the read buffer given to each checked file
+const int CHECK_BUFFER_SIZE = 1 << 16;
+
+//Standard use constructor, starting with one group for all persons like the ledger
+Checker::Checker() : quit_(false), errors_(0), warnings_(0)
+{
+  groups_["All"];
+}
+
+//Opens and checks a file, reporting a problem if it cannot be opened
+//Returns the number of errors found so far
+int Checker::checkFile(const std::string & filename)
+{
+  //Give the stream a large buffer; this must happen before opening
+  std::vector<char> buffer(CHECK_BUFFER_SIZE);
+  std::ifstream fin;
+  fin.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+  fin.open(filename.c_str(), std::ifstream::in);
+  if (!fin)
+    {
+      Diagnostic d = {filename, 0, 0, true, "Could not find/open file " + filename + "."};
+      diagnostics_.push_back(d);
+      errors_++;
+      return errors_;
+    }
+
+  check(fin, filename);
+  fin.close();
+  return errors_;
+}
+
+//Reads the whole stream, checking every line against the known names
+//Returns the number of errors found so far
+int Checker::check(std::istream & input, const std::string & filename)
+{
+  files_.push_back(filename);
+  keys_.push_back(Loader::key(filename));
+  quit_ = false;
+
+  int lineNum = 0;
+  bool ignored = false;
+  std::string line;
+  while (std::getline(input, line))
+    {
+      lineNum++;
+
+      //Split on spaces the same way the parser does, remembering where each token started
+      tokenize(line, tokens_, &columns_);
+
+      //Empty line
+      if (tokens_.size() == 0) continue;
+
+      //Anything after a quit is never read
+      if (quit_)
+	{
+	  if (tokens_[0][0] != '%' && !ignored)
+	    {
+	      warning(lineNum, 0, "Lines after quit are ignored.");
+	      ignored = true;
+	    }
+	  continue;
+	}
+
+      checkLine(lineNum);
+    }
+
+  files_.pop_back();
+  keys_.pop_back();
+  quit_ = false;
+  return errors_;
+}
+
+//Checks the current line, updating the known names as a command would
+void Checker::checkLine(int lineNum)
+{
+  const std::vector<std::string> & tokens = tokens_;
+
+  //Comments are done by starting the line with a %
+  if (tokens[0][0] == '%')
+    {
+      //Do nothing
+    }
+
+  //group GROUPNAME
+  else if (tokens[0] == "group")
+    {
+      if (tokens.size() != 2)
+	{
+	  error(lineNum, 0, "Group command only takes one argument.");
+	  return;
+	}
+      if (groupExists(tokens[1]))
+	{
+	  warning(lineNum, 1, "Group name \"" + tokens[1] + "\" already in use.");
+	  return;
+	}
+      groups_[tokens[1]];
+    }
+
+  //person PERSONNAME
+  else if (tokens[0] == "person")
+    {
+      if (tokens.size() != 2)
+	{
+	  error(lineNum, 0, "Person command only takes one argument.");
+	  return;
+	}
+      if (personExists(tokens[1]))
+	{
+	  warning(lineNum, 1, "Person name \"" + tokens[1] + "\" already in use.");
+	  return;
+	}
+      persons_.insert(tokens[1]);
+      groups_["All"].insert(tokens[1]);
+    }
+
+  //join GROUPNAME PERSONNAME1 PERSONNAME2 ...
+  else if (tokens[0] == "join")
+    {
+      if (tokens.size() < 3)
+	{
+	  error(lineNum, 0, "Join command must have at least two arguments.");
+	  return;
+	}
+      std::map<std::string, std::set<std::string> >::iterator g = groups_.find(tokens[1]);
+      if (g == groups_.end())
+	{
+	  error(lineNum, 1, "Group " + tokens[1] + " does not exist.");
+	  return;
+	}
+      for (size_t i = 2; i < tokens.size(); i++)
+	{
+	  if (!personExists(tokens[i]))
+	    {
+	      error(lineNum, i, "Person " + tokens[i] + " does not exist.");
+	      continue;
+	    }
+	  g->second.insert(tokens[i]);
+	}
+    }
+
+  //leave GROUPNAME PERSONNAME1 PERSONNAME2 ...
+  else if (tokens[0] == "leave")
+    {
+      if (tokens.size() < 3)
+	{
+	  error(lineNum, 0, "Leave command must have at least two arguments.");
+	  return;
+	}
+      std::map<std::string, std::set<std::string> >::iterator g = groups_.find(tokens[1]);
+      if (g == groups_.end())
+	{
+	  error(lineNum, 1, "Group " + tokens[1] + " does not exist.");
+	  return;
+	}
+      for (size_t i = 2; i < tokens.size(); i++)
+	{
+	  if (g->second.erase(tokens[i]) == 0)
+	    {
+	      error(lineNum, i, "Person " + tokens[i] + " is not in group " + tokens[1] + ".");
+	    }
+	}
+    }
+
+  //groupdel GROUPNAME
+  else if (tokens[0] == "groupdel")
+    {
+      if (tokens.size() != 2)
+	{
+	  error(lineNum, 0, "Groupdel command only takes one argument.");
+	  return;
+	}
+      if (!groupExists(tokens[1]))
+	{
+	  error(lineNum, 1, "Group " + tokens[1] + " already does not exist.");
+	  return;
+	}
+      if (tokens[1] == "All")
+	{
+	  error(lineNum, 1, "Group All cannot be deleted.");
+	  return;
+	}
+      groups_.erase(tokens[1]);
+    }
+
+  //persondel PERSONNAME
+  else if (tokens[0] == "persondel")
+    {
+      if (tokens.size() != 2)
+	{
+	  error(lineNum, 0, "Persondel command only takes one argument.");
+	  return;
+	}
+      if (!personExists(tokens[1]))
+	{
+	  error(lineNum, 1, "Person " + tokens[1] + " already does not exist.");
+	  return;
+	}
+      persons_.erase(tokens[1]);
+      for (std::map<std::string, std::set<std::string> >::iterator g = groups_.begin(); g != groups_.end(); g++)
+	{
+	  g->second.erase(tokens[1]);
+	}
+    }
+
+  //tx PAYER AMOUNT CATEGORY PERSONNAME1 group GROUPNAME1 PERSONNAME2
+  else if (tokens[0] == "tx")
+    {
+      if (tokens.size() < 5)
+	{
+	  error(lineNum, 0, "tx command takes at least 5 arguments.");
+	  return;
+	}
+      if (!personExists(tokens[1]))
+	{
+	  error(lineNum, 1, "Person " + tokens[1] + " does not exist.");
+	}
+
+      //Parse the amount the same way the parser does, but notice junk
+      const char * text = tokens[2].c_str();
+      char * end;
+      double value = strtod(text, &end);
+      int amount = (value * 100.0) + 0.5;
+      if (amount == 0)
+	{
+	  error(lineNum, 2, "Amount must be a number greater than 0.");
+	}
+      else if (*end != '\0')
+	{
+	  warning(lineNum, 2, "Amount \"" + tokens[2] + "\" has trailing characters.");
+	}
+      else if (amount < 0)
+	{
+	  warning(lineNum, 2, "Amount \"" + tokens[2] + "\" is negative.");
+	}
+
+      checkPayees(lineNum, 4);
+    }
+
+  //recur PAYER AMOUNT CATEGORY PERIOD START [until END] PERSONNAME1 group GROUPNAME1 ...
+  else if (tokens[0] == "recur")
+    {
+      if (tokens.size() < 7)
+	{
+	  error(lineNum, 0, "recur command takes at least 6 arguments.");
+	  return;
+	}
+      if (!personExists(tokens[1]))
+	{
+	  error(lineNum, 1, "Person " + tokens[1] + " does not exist.");
+	}
+      if (int(atof(tokens[2].c_str()) * 100.0 + 0.5) == 0)
+	{
+	  error(lineNum, 2, "Amount must be a number greater than 0.");
+	}
+      Recurrence::Period period;
+      if (!Recurrence::parsePeriod(tokens[4], period))
+	{
+	  error(lineNum, 4, "Period must be daily, weekly, monthly or yearly.");
+	}
+      int start, end;
+      if (!Recurrence::parseDate(tokens[5], start))
+	{
+	  error(lineNum, 5, "Start date must be written YYYY-MM-DD.");
+	}
+      size_t first = 6;
+      if (tokens[6] == "until")
+	{
+	  if (tokens.size() < 9)
+	    {
+	      error(lineNum, 6, "End date must be followed by who pays.");
+	      return;
+	    }
+	  if (!Recurrence::parseDate(tokens[7], end))
+	    {
+	      error(lineNum, 7, "End date must be written YYYY-MM-DD.");
+	    }
+	  else if (Recurrence::parseDate(tokens[5], start) && end < start)
+	    {
+	      error(lineNum, 7, "End date is before the start date.");
+	    }
+	  first = 8;
+	}
+
+      checkPayees(lineNum, first);
+    }
+
+  //debt PERSONNAME1 [PERSONNAME2]
+  else if (tokens[0] == "debt")
+    {
+      if (tokens.size() > 3)
+	{
+	  error(lineNum, 3, "debt command takes no more than 2 arguments.");
+	  return;
+	}
+      if (tokens.size() == 1)
+	{
+	  error(lineNum, 0, "debt command requires at least one argument.");
+	  return;
+	}
+      for (size_t i = 1; i < tokens.size(); i++)
+	{
+	  if (!personExists(tokens[i])) error(lineNum, i, "person " + tokens[i] + " does not exist.");
+	}
+    }
+
+  //matrix all | group GROUPNAME [csv]
+  else if (tokens[0] == "matrix")
+    {
+      size_t length = tokens.size() > 1 && tokens[tokens.size()-1] == "csv" ? tokens.size() - 1 : tokens.size();
+      if (!(length == 2 && tokens[1] == "all") && !(length == 3 && tokens[1] == "group"))
+	{
+	  error(lineNum, 0, "matrix command takes \"all\" or \"group GROUPNAME\", then optionally \"csv\".");
+	}
+      else if (length == 3 && !groupExists(tokens[2]))
+	{
+	  error(lineNum, 2, "Group " + tokens[2] + " does not exist.");
+	}
+    }
+
+  //load FILENAME
+  else if (tokens[0] == "load")
+    {
+      if (tokens.size() != 2)
+	{
+	  error(lineNum, 0, "load command takes only one argument.");
+	  return;
+	}
+
+      //A file loading itself, directly or not, would never finish, however its path is written
+      std::string key = Loader::key(tokens[1]);
+      for (size_t i = 0; i < keys_.size(); i++)
+	{
+	  if (keys_[i] == key)
+	    {
+	      error(lineNum, 1, "File " + tokens[1] + " is already being loaded.");
+	      return;
+	    }
+	}
+
+      //Check the loaded file in place, then carry on with this one
+      int before = errors_;
+      std::vector<std::string> savedTokens = tokens_;
+      std::vector<int> savedColumns = columns_;
+      checkFile(savedTokens[1]);
+      tokens_ = savedTokens;
+      columns_ = savedColumns;
+      if (errors_ != before)
+	{
+	  error(lineNum, 1, "Failed to read file " + tokens_[1] + ".");
+	}
+    }
+
+  //compact OUTFILE [before LINE]
+  else if (tokens[0] == "compact")
+    {
+      if (tokens.size() != 2 && !(tokens.size() == 4 && tokens[2] == "before"))
+	{
+	  error(lineNum, 0, "compact command takes an output file and optionally \"before LINE\".");
+	}
+      else if (tokens.size() == 4 && atoi(tokens[3].c_str()) < 1)
+	{
+	  error(lineNum, 3, "Line must be a number greater than 0.");
+	}
+    }
+
+  //export csv|json FILENAME [balances|transactions|members]
+  else if (tokens[0] == "export")
+    {
+      if (tokens.size() != 3 && tokens.size() != 4)
+	{
+	  error(lineNum, 0, "export command takes a format, a file and optionally what to export.");
+	  return;
+	}
+      if (tokens[1] != "csv" && tokens[1] != "json")
+	{
+	  error(lineNum, 1, "Format must be csv or json.");
+	}
+      if (tokens.size() == 4 && tokens[3] != "balances" && tokens[3] != "transactions" && tokens[3] != "members")
+	{
+	  error(lineNum, 3, "Can only export balances, transactions or members.");
+	}
+    }
+
+  //mem
+  else if (tokens[0] == "mem")
+    {
+      if (tokens.size() != 1) error(lineNum, 1, "mem command takes no arguments.");
+    }
+
+  //quit
+  else if (tokens[0] == "quit")
+    {
+      quit_ = true;
+    }
+
+  //info PERSONNAME | group GROUPNAME
+  else if (tokens[0] == "info")
+    {
+      if (tokens.size() > 3 || tokens.size() == 1)
+	{
+	  error(lineNum, 0, "info command takes no more than 2 arguments.");
+	}
+      else if (tokens.size() == 2)
+	{
+	  if (!personExists(tokens[1])) error(lineNum, 1, "Person " + tokens[1] + " does not exist.");
+	}
+      else if (tokens[1] != "group")
+	{
+	  error(lineNum, 1, "Expected \"group\" but found \"" + tokens[1] + "\".");
+	}
+      else if (!groupExists(tokens[2]))
+	{
+	  error(lineNum, 2, "Group " + tokens[2] + " does not exist.");
+	}
+    }
+
+  //help [COMMAND]
+  else if (tokens[0] == "help")
+    {
+      static const char * commands[] = {"person", "group", "join", "leave", "groupdel", "persondel",
+					"tx", "recur", "debt", "info", "matrix", "load", "compact", "export", "mem", "quit", "help"};
+      if (tokens.size() == 1) return;
+      for (size_t i = 0; i < sizeof(commands)/sizeof(commands[0]); i++)
+	{
+	  if (tokens[1] == commands[i]) return;
+	}
+      warning(lineNum, 1, "Command \"" + tokens[1] + "\" does not exist.");
+    }
+
+  //Unrecognized command
+  else
+    {
+      error(lineNum, 0, "Unrecognized command " + tokens[0] + ".");
+    }
+}
+
+//Checks a list of payees and groups starting at the given token
+void Checker::checkPayees(int lineNum, size_t first)
+{
+  const std::vector<std::string> & tokens = tokens_;
+  bool anyone = false;
+  for (size_t i = first; i < tokens.size(); i++)
+    {
+      //If it is a group
+      if (tokens[i] == "group")
+	{
+	  i++;
+	  if (i == tokens.size())
+	    {
+	      error(lineNum, i - 1, "No group specified.");
+	      return;
+	    }
+
+	  std::map<std::string, std::set<std::string> >::const_iterator g = groups_.find(tokens[i]);
+	  if (g == groups_.end())
+	    {
+	      error(lineNum, i, "Group " + tokens[i] + " does not exist.");
+	      return;
+	    }
+	  if (!g->second.empty()) anyone = true;
+	  continue;
+	}
+
+      if (!personExists(tokens[i]))
+	{
+	  error(lineNum, i, "Person " + tokens[i] + " does not exist.");
+	  return;
+	}
+      anyone = true;
+    }
+
+  //The amount is split evenly, so someone has to be paying
+  if (!anyone) error(lineNum, first, "Nobody to split the amount between.");
+}
+
+//Records an error at the given token of the current line
+void Checker::error(int lineNum, size_t token, const std::string & message)
+{
+  int column = token < columns_.size() ? columns_[token] : 0;
+  Diagnostic d = {files_.empty() ? "" : files_.back(), lineNum, column, true, message};
+  diagnostics_.push_back(d);
+  errors_++;
+}
+
+//Records a warning at the given token of the current line
+void Checker::warning(int lineNum, size_t token, const std::string & message)
+{
+  int column = token < columns_.size() ? columns_[token] : 0;
+  Diagnostic d = {files_.empty() ? "" : files_.back(), lineNum, column, false, message};
+  diagnostics_.push_back(d);
+  warnings_++;
+}
+
+//Writes every diagnostic in the order found, one per line
+void Checker::report(std::ostream & out) const
+{
+  for (std::vector<Diagnostic>::const_iterator i = diagnostics_.begin(); i != diagnostics_.end(); i++)
+    {
+      out << i->file << ':' << i->line << ':' << i->column << ": " <<
+	(i->error ? "ERROR: " : "WARNING: ") << i->message << '\n';
+    }
+}
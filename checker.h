@@ -0,0 +1,79 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Checker Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the header for a class which validates a transaction file in a
+  single pass, tracking only names and group membership.
+*/
+
+#ifndef _checker_h_
+#define _checker_h_
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+class Checker
+{
+ public:
+  //Constructors
+  Checker();
+
+  //Accessors
+  int errors() const {return errors_;}
+  int warnings() const {return warnings_;}
+
+  //General use functions
+  int checkFile(const std::string & filename);
+  int check(std::istream & input, const std::string & filename);
+  void report(std::ostream & out) const;
+
+ private:
+  //A single problem found in the input
+  struct Diagnostic
+  {
+    std::string file;
+    int line;
+    int column;
+    bool error;
+    std::string message;
+  };
+
+  //Helpers for checking a single line
+  void checkLine(int lineNum);
+  void checkPayees(int lineNum, size_t first);
+  bool groupExists(const std::string & name) const {return groups_.find(name) != groups_.end();}
+  bool personExists(const std::string & name) const {return persons_.find(name) != persons_.end();}
+  void error(int lineNum, size_t token, const std::string & message);
+  void warning(int lineNum, size_t token, const std::string & message);
+
+  //The names of all persons, and each group with its members
+  std::set<std::string> persons_;
+  std::map<std::string, std::set<std::string> > groups_;
+
+  //The files currently being checked, innermost last, as named and as the
+  //loader tells them apart
+  std::vector<std::string> files_;
+  std::vector<std::string> keys_;
+
+  //Set once a quit command is seen, ending the current file
+  bool quit_;
+
+  //The tokens of the current line and the column each started at
+  std::vector<std::string> tokens_;
+  std::vector<int> columns_;
+
+  //Everything found so far
+  std::vector<Diagnostic> diagnostics_;
+  int errors_;
+  int warnings_;
+};
+
+#endif
@@ -0,0 +1,247 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Exporter Implementation File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the implementation for a class which writes balances, transactions
+  and group members out as CSV or JSON for other programs to read.
+*/
+
+#include "exporter.h"
+
+//Standard use constructor
+Exporter::Exporter(Writer & inout, Format informat) :
+  out_(inout), format_(informat), columns_(NULL), count_(0), column_(0), rows_(0) {}
+
+//Writes what each person owes each other person, one row per pair that owes anything
+//Returns the number of rows written
+long Exporter::balances(const Ledger & ledger)
+{
+  static const char * columns[] = {"debtor", "creditor", "amount"};
+  begin(columns, 3);
+
+  int day = Recurrence::today();
+  std::vector<Ledger::Pair> pairs = ledger.pairs();
+  for (size_t i = 0; i < pairs.size(); i++)
+    {
+      //Write it as the one who owes
+      const Person * a = pairs[i].first;
+      const Person * b = pairs[i].second;
+      int net = a->historyDebt(b->name()) + a->recurringDebt(b->name(), day) -
+	b->historyDebt(a->name()) - b->recurringDebt(a->name(), day);
+      if (net == 0) continue;
+      row();
+      text(net > 0 ? a->name() : b->name());
+      text(net > 0 ? b->name() : a->name());
+      cents(net > 0 ? net : -net);
+    }
+
+  end();
+  return rows_;
+}
+
+//Writes every payment each person owes, including repeating payments up to today
+//Returns the number of rows written
+long Exporter::transactions(const Ledger & ledger)
+{
+  static const char * columns[] = {"debtor", "creditor", "description", "date", "amount"};
+  begin(columns, 5);
+
+  int day = Recurrence::today();
+  std::map<std::string, const Person*> index = ledger.live();
+  for (std::map<std::string, const Person*>::iterator a = index.begin(); a != index.end(); a++)
+    {
+      //Recorded payments have no date
+      const Person::Debts & debts = a->second->debts();
+      for (Person::Debts::const_iterator d = debts.begin(); d != debts.end(); d++)
+	{
+	  if (d->first == a->first) continue;
+	  for (Person::History::const_iterator i = d->second.begin(); i != d->second.end(); i++)
+	    {
+	      row();
+	      text(a->first);
+	      text(d->first);
+	      text(i->first);
+	      field();
+	      if (format_ == JSON) out_.put("null");
+	      cents(i->second);
+	    }
+	}
+
+      //Repeating payments are expanded straight from their schedule
+      const Person::Recurrences & rules = a->second->recurrences();
+      for (Person::Recurrences::const_iterator r = rules.begin(); r != rules.end(); r++)
+	{
+	  if (r->first == a->first) continue;
+	  for (std::pmr::list<Recurrence>::const_iterator i = r->second.begin(); i != r->second.end(); i++)
+	    {
+	      int n = i->count(day);
+	      for (int k = 0; k < n; k++)
+		{
+		  row();
+		  text(a->first);
+		  text(r->first);
+		  text(i->desc());
+		  date(i->date(k));
+		  cents(i->amount());
+		}
+	    }
+	}
+    }
+
+  end();
+  return rows_;
+}
+
+//Writes one row for each member of each group
+//Returns the number of rows written
+long Exporter::members(const GroupList & groups)
+{
+  static const char * columns[] = {"group", "person"};
+  begin(columns, 2);
+
+  for (GroupList::const_iterator g = groups.begin(); g != groups.end(); g++)
+    {
+      for (std::pmr::set<std::string>::const_iterator i = g->persons().begin(); i != g->persons().end(); i++)
+	{
+	  row();
+	  text(g->name());
+	  text(*i);
+	}
+    }
+
+  end();
+  return rows_;
+}
+
+//Reads a format name, returning false if it is not one
+bool Exporter::parseFormat(const std::string & text, Format & format)
+{
+  if (text == "csv") format = CSV;
+  else if (text == "json") format = JSON;
+  else return false;
+  return true;
+}
+
+//Starts a table with the given columns
+void Exporter::begin(const char * const * columns, int count)
+{
+  columns_ = columns;
+  count_ = count;
+  column_ = count;
+  rows_ = 0;
+
+  if (format_ == JSON)
+    {
+      out_.put('[');
+      return;
+    }
+
+  for (int i = 0; i < count; i++)
+    {
+      if (i > 0) out_.put(',');
+      out_.put(columns[i]);
+    }
+  out_.put('\n');
+}
+
+//Starts a new row, finishing the last one
+void Exporter::row()
+{
+  if (format_ == JSON)
+    {
+      if (rows_ > 0) out_.put("},\n{", 4);
+      else out_.put("\n{", 2);
+    }
+  else if (rows_ > 0) out_.put('\n');
+
+  column_ = 0;
+  rows_++;
+}
+
+//Finishes the last row and the table
+void Exporter::end()
+{
+  if (format_ == JSON) out_.put(rows_ > 0 ? "}\n]\n" : "]\n");
+  else if (rows_ > 0) out_.put('\n');
+}
+
+//Starts the next field of the current row
+void Exporter::field()
+{
+  if (format_ == JSON)
+    {
+      if (column_ > 0) out_.put(',');
+      out_.put('"');
+      out_.put(columns_[column_]);
+      out_.put("\":", 2);
+    }
+  else if (column_ > 0) out_.put(',');
+
+  column_++;
+}
+
+//Writes a text field, quoting it as the format needs
+void Exporter::text(std::string_view value)
+{
+  field();
+
+  if (format_ == JSON)
+    {
+      out_.put('"');
+      for (size_t i = 0; i < value.size(); i++)
+	{
+	  char c = value[i];
+	  if (c == '"' || c == '\\')
+	    {
+	      out_.put('\\');
+	      out_.put(c);
+	    }
+	  else if ((unsigned char)c < 0x20)
+	    {
+	      static const char hex[] = "0123456789abcdef";
+	      out_.put("\\u00", 4);
+	      out_.put(hex[(c >> 4) & 0xf]);
+	      out_.put(hex[c & 0xf]);
+	    }
+	  else out_.put(c);
+	}
+      out_.put('"');
+      return;
+    }
+
+  //CSV only needs quotes around fields with commas, quotes or line breaks
+  if (value.find_first_of(",\"\r\n") == std::string_view::npos)
+    {
+      out_.put(value);
+      return;
+    }
+  out_.put('"');
+  for (size_t i = 0; i < value.size(); i++)
+    {
+      if (value[i] == '"') out_.put('"');
+      out_.put(value[i]);
+    }
+  out_.put('"');
+}
+
+//Writes an amount of cents as dollars
+void Exporter::cents(int value)
+{
+  field();
+  out_.putCents(value);
+}
+
+//Writes a day as YYYY-MM-DD
+void Exporter::date(int day)
+{
+  field();
+  int y, m, d;
+  Recurrence::toCivil(day, y, m, d);
+  if (format_ == JSON) out_.put('"');
+  out_.putDate(y, m, d);
+  if (format_ == JSON) out_.put('"');
+}
@@ -0,0 +1,64 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Exporter Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the header for a class which writes balances, transactions and
+  group members out as CSV or JSON for other programs to read.
+*/
+
+#ifndef _exporter_h_
+#define _exporter_h_
+
+#include <list>
+#include <map>
+#include <string>
+#include <string_view>
+#include "group.h"
+#include "ledger.h"
+#include "person.h"
+#include "writer.h"
+
+class Exporter
+{
+ public:
+  //The file formats which can be written
+  enum Format {CSV, JSON};
+
+  //Constructors
+  Exporter(Writer & inout, Format informat);
+
+  //General use functions
+  long balances(const Ledger & ledger);
+  long transactions(const Ledger & ledger);
+  long members(const GroupList & groups);
+
+  static bool parseFormat(const std::string & text, Format & format);
+
+ private:
+  //Starting and ending the table and its rows
+  void begin(const char * const * columns, int count);
+  void row();
+  void end();
+
+  //Writing each field of a row, in column order
+  void field();
+  void text(std::string_view value);
+  void cents(int value);
+  void date(int day);
+
+  //Where to write, and how
+  Writer & out_;
+  Format format_;
+
+  //The column names, the next column to write, and how many rows so far
+  const char * const * columns_;
+  int count_;
+  int column_;
+  long rows_;
+};
+
+#endif
@@ -10,6 +10,127 @@
 */
 
 #include "group.h"
+#include <algorithm>
 
-//Standard use constructor
-Group::Group(std::string inname) : name_(inname) {}
+//Standard use constructor, allocating from the given ledger's pools
+Group::Group(std::string inname, Memory & memory) : name_(inname), persons_(memory.membership().resource()),
+						    membership_(memory.totals().resource()), spent_(0), shares_(0),
+						    paid_(memory.totals().resource()), joined_(memory.totals().resource()),
+						    owed_(memory.totals().resource()), recurring_(memory.totals().resource()),
+						    recurringShares_(memory.totals().resource()) {}
+
+//Adds a member, who takes a share of everything charged from now on
+//Returns true if they were not already a member
+bool Group::addPerson(const std::string & inname)
+{
+  if (!persons_.insert(inname).second) return false;
+  joined_[inname] = shares_;
+  membership_.push_back(std::make_pair(inname, true));
+  return true;
+}
+
+//Removes a member, keeping the shares they took on while in the group
+//Returns true if they were a member
+bool Group::removePerson(const std::string & inname)
+{
+  if (persons_.erase(inname) == 0) return false;
+  std::pmr::map<std::string, int>::iterator j = joined_.find(inname);
+  owed_[inname] += shares_ - j->second;
+  joined_.erase(j);
+  membership_.push_back(std::make_pair(inname, false));
+  return true;
+}
+
+//Records a payment split evenly between every current member, except those
+//whose share was charged to another group (given in name order)
+void Group::charge(const std::string & payer, int perPerson, const std::vector<std::string> & skipped)
+{
+  int members = size() - skipped.size();
+  if (members == 0) return;
+  spent_ += perPerson * members;
+  paid_[payer] += perPerson * members;
+
+  //Usually everyone is charged, which only needs the running total of shares
+  if (skipped.empty())
+    {
+      shares_ += perPerson;
+      return;
+    }
+  for (std::pmr::set<std::string>::const_iterator i = persons_.begin(); i != persons_.end(); i++)
+    {
+      if (!std::binary_search(skipped.begin(), skipped.end(), *i)) owed_[*i] += perPerson;
+    }
+}
+
+//Records a repeating payment split between every current member, except those
+//whose share was charged to another group (given in name order)
+void Group::chargeRecurring(const std::string & payer, const Recurrence & rule, const std::vector<std::string> & skipped)
+{
+  int members = size() - skipped.size();
+  if (members == 0) return;
+  recurring_.push_back(Recurring{payer, rule, members});
+  const Recurring * r = &recurring_.back();
+  recurringShares_[payer].push_back(std::make_pair(r, members));
+  for (std::pmr::set<std::string>::const_iterator i = persons_.begin(); i != persons_.end(); i++)
+    {
+      if (!std::binary_search(skipped.begin(), skipped.end(), *i)) recurringShares_[*i].push_back(std::make_pair(r, -1));
+    }
+}
+
+//Returns the total charged through the group, up to and including the given day
+int Group::spent(int day) const
+{
+  int total = spent_;
+  for (std::pmr::list<Recurring>::const_iterator r = recurring_.begin(); r != recurring_.end(); r++)
+    {
+      total += r->rule.owed(day) * r->members;
+    }
+  return total;
+}
+
+//Returns how much a person has put into the group beyond their own share, up to
+//and including the given day. Negative if they have put in less.
+int Group::net(const std::string & inname, int day) const
+{
+  int total = 0;
+  std::pmr::map<std::string, int>::const_iterator i = paid_.find(inname);
+  if (i != paid_.end()) total += i->second;
+  i = owed_.find(inname);
+  if (i != owed_.end()) total -= i->second;
+  i = joined_.find(inname);
+  if (i != joined_.end()) total -= shares_ - i->second;
+
+  std::pmr::map<std::string, Shares>::const_iterator s = recurringShares_.find(inname);
+  if (s == recurringShares_.end()) return total;
+  for (size_t k = 0; k < s->second.size(); k++)
+    {
+      total += s->second[k].first->rule.owed(day) * s->second[k].second;
+    }
+  return total;
+}
+
+//Returns how many entries the running totals and membership history hold
+size_t Group::records() const
+{
+  size_t count = membership_.size() + paid_.size() + joined_.size() + owed_.size() + recurring_.size();
+  for (std::pmr::map<std::string, Shares>::const_iterator i = recurringShares_.begin(); i != recurringShares_.end(); i++)
+    {
+      count += i->second.size();
+    }
+  return count;
+}
+
+//Returns everyone with a position in the group: members past and present, and
+//anyone who has paid for it
+std::set<std::string> Group::involved() const
+{
+  std::set<std::string> names;
+  for (std::pmr::map<std::string, int>::const_iterator i = paid_.begin(); i != paid_.end(); i++) names.insert(i->first);
+  for (std::pmr::map<std::string, int>::const_iterator i = owed_.begin(); i != owed_.end(); i++) names.insert(i->first);
+  for (std::pmr::map<std::string, int>::const_iterator i = joined_.begin(); i != joined_.end(); i++) names.insert(i->first);
+  for (std::pmr::map<std::string, Shares>::const_iterator i = recurringShares_.begin(); i != recurringShares_.end(); i++)
+    {
+      names.insert(i->first);
+    }
+  return names;
+}
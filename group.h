@@ -13,33 +13,84 @@
 #define _group_h_
 
 #include <set>
+#include <map>
 #include <string>
+#include <vector>
+#include <list>
+#include <memory_resource>
+#include "memory.h"
+#include "recurrence.h"
 
 class Group
 {
  public:
   //Constructors
-  Group(std::string inname);
+  Group(std::string inname, Memory & memory);
 
   //Accessors
   const std::string & name() const {return name_;}
-  const std::set<std::string> & persons() const {return persons_;}
+  const std::pmr::set<std::string> & persons() const {return persons_;}
   int size() const {return persons_.size();}
+  const std::pmr::list<std::pair<std::string,bool> > & membership() const {return membership_;}
 
   //Mutators
   void setName(const std::string & inname) {name_ = inname;}
-  bool addPerson(const std::string & inname) {return persons_.insert(inname).second;}
-  bool removePerson(const std::string & inname) {return persons_.erase(inname) > 0;}
+  bool addPerson(const std::string & inname);
+  bool removePerson(const std::string & inname);
+  void charge(const std::string & payer, int perPerson, const std::vector<std::string> & skipped);
+  void chargeRecurring(const std::string & payer, const Recurrence & rule, const std::vector<std::string> & skipped);
 
   //General use functions
   bool hasMember(const std::string & inname) const {return persons_.find(inname) != persons_.end();}
+  int spent(int day) const;
+  int net(const std::string & inname, int day) const;
+  std::set<std::string> involved() const;
+  size_t records() const;
 
  private:
+  //Not copyable, since the shares point into the list of repeating payments
+  Group(const Group &);
+  Group & operator=(const Group &);
+
   //The name of the group
   std::string name_;
 
-  //The list of Person names in the group
-  std::set<std::string> persons_;
+  //The list of Person names in the group, kept in the membership pool
+  std::pmr::set<std::string> persons_;
+
+  //Everyone who has joined (true) or left (false), in order
+  //This and the running totals below are kept in the group totals pool.
+  std::pmr::list<std::pair<std::string,bool> > membership_;
+
+  //Running totals for everything charged through the group: the total spent, the
+  //sum of every member's share, and what each payer put in
+  int spent_;
+  int shares_;
+  std::pmr::map<std::string, int> paid_;
+
+  //The total of shares when each current member joined, and the shares each
+  //person took on apart from those: while they were a member before, or when
+  //only some members were charged
+  std::pmr::map<std::string, int> joined_;
+  std::pmr::map<std::string, int> owed_;
+
+  //Repeating payments charged through the group, with how many members they
+  //were split between, counted only when needed
+  struct Recurring
+  {
+    std::string payer;
+    Recurrence rule;
+    int members;
+  };
+  std::pmr::list<Recurring> recurring_;
+
+  //The repeating payments each person paid (once for each member) or owes a
+  //share of (-1), so their position only looks at their own
+  typedef std::pmr::vector<std::pair<const Recurring*, int> > Shares;
+  std::pmr::map<std::string, Shares> recurringShares_;
 };
 
+//Every group, kept in the group pool
+typedef std::pmr::list<Group> GroupList;
+
 #endif
@@ -0,0 +1,390 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Ledger Implementation File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the implementation of the Ledger class
+*/
+
+#include "ledger.h"
+#include <algorithm>
+#include <set>
+
+//Standard use constructor, starting with only the group of all persons
+Ledger::Ledger() : groups_(memory_.groups().resource()), persons_(memory_.persons().resource()),
+		   index_(memory_.persons().resource())
+{
+  groups_.emplace_back("All", memory_);
+  all_ = &groups_.back();
+}
+
+//Returns the person with the given name, or NULL if there is none
+//A person exists while they are in group All; one who has left it keeps their
+//debts, but is not found until they are added again.
+const Person * Ledger::person(const std::string & name) const
+{
+  if (!all_->hasMember(name)) return NULL;
+  PersonIndex::const_iterator p = index_.find(name);
+  return p == index_.end() ? NULL : p->second;
+}
+
+//Returns the group with the given name, or NULL if there is none
+const Group * Ledger::group(const std::string & name) const
+{
+  for (GroupList::const_iterator g = groups_.begin(); g != groups_.end(); g++)
+    {
+      if (g->name() == name) return &(*g);
+    }
+  return NULL;
+}
+
+//Adds a person, who is also placed in group All
+//Adding one who has left All puts them back, with what they owed before.
+Ledger::Status Ledger::addPerson(const std::string & name)
+{
+  if (all_->hasMember(name)) return NAME_TAKEN;
+  all_->addPerson(name);
+  if (index_.find(name) != index_.end()) return OK;
+  persons_.emplace_back(name, memory_);
+  index_[persons_.back().name()] = &persons_.back();
+  return OK;
+}
+
+//Removes a person from every group, along with all they owe
+Ledger::Status Ledger::removePerson(const std::string & name)
+{
+  Person * p = findPerson(name);
+  if (p == NULL) return NO_SUCH_PERSON;
+
+  for (GroupList::iterator g = groups_.begin(); g != groups_.end(); g++)
+    {
+      g->removePerson(name);
+    }
+  index_.erase(name);
+  for (PersonList::iterator i = persons_.begin(); i != persons_.end(); i++)
+    {
+      if (&(*i) == p)
+	{
+	  persons_.erase(i);
+	  break;
+	}
+    }
+  return OK;
+}
+
+//Adds an empty group
+Ledger::Status Ledger::addGroup(const std::string & name)
+{
+  if (group(name) != NULL) return NAME_TAKEN;
+  groups_.emplace_back(name, memory_);
+  return OK;
+}
+
+//Removes a group; its members and their debts are left alone
+Ledger::Status Ledger::removeGroup(const std::string & name)
+{
+  for (GroupList::iterator g = groups_.begin(); g != groups_.end(); g++)
+    {
+      if (g->name() != name) continue;
+      if (&(*g) == all_) return PROTECTED_GROUP;
+      groups_.erase(g);
+      return OK;
+    }
+  unknown_ = name;
+  return NO_SUCH_GROUP;
+}
+
+//Adds a person to a group; joining twice does nothing
+Ledger::Status Ledger::join(const std::string & groupName, const std::string & personName)
+{
+  Group * g = findGroup(groupName);
+  if (g == NULL) return NO_SUCH_GROUP;
+  if (findPerson(personName) == NULL) return NO_SUCH_PERSON;
+  g->addPerson(personName);
+  return OK;
+}
+
+//Removes a person from a group
+Ledger::Status Ledger::leave(const std::string & groupName, const std::string & personName)
+{
+  Group * g = findGroup(groupName);
+  if (g == NULL) return NO_SUCH_GROUP;
+  if (!g->removePerson(personName))
+    {
+      unknown_ = personName;
+      return NOT_A_MEMBER;
+    }
+  return OK;
+}
+
+//Records a payment split evenly between the payees, groups expanded into their
+//members. If split is given, it is filled in with how the payment was split.
+Ledger::Status Ledger::addTransaction(const std::string & payer, Money amount, const std::string & desc,
+				      const Payees & payees, Split * split)
+{
+  if (findPerson(payer) == NULL) return NO_SUCH_PERSON;
+  if (amount == Money(0)) return BAD_AMOUNT;
+
+  Split local;
+  Split & s = split == NULL ? local : *split;
+  Status status = this->split(payees, s, &unknown_);
+  if (status != OK) return status;
+  s.each = amount.split(s.debtors.size());
+
+  for (size_t i = 0; i < s.debtors.size(); i++)
+    {
+      index_[s.debtors[i]]->addDebt(payer, s.each.cents(), desc);
+    }
+  for (size_t i = 0; i < s.groups.size(); i++)
+    {
+      findGroup(s.groups[i])->charge(payer, s.each.cents(), s.skipped[i]);
+    }
+  return OK;
+}
+
+//Records a payment repeating from start until end (or Recurrence::NEVER), split
+//evenly between the payees. Occurrences are only counted when a balance is asked for.
+Ledger::Status Ledger::addRecurring(const std::string & payer, Money amount, const std::string & desc,
+				    Recurrence::Period period, int start, int end, const Payees & payees, Split * split)
+{
+  if (findPerson(payer) == NULL) return NO_SUCH_PERSON;
+  if (amount == Money(0)) return BAD_AMOUNT;
+  if (end < start) return BAD_DATES;
+
+  Split local;
+  Split & s = split == NULL ? local : *split;
+  Status status = this->split(payees, s, &unknown_);
+  if (status != OK) return status;
+  s.each = amount.split(s.debtors.size());
+
+  //Every payee's copy of the rule shares one stored description
+  Recurrence rule(memory_.intern(desc), s.each.cents(), period, start, end);
+  for (size_t i = 0; i < s.debtors.size(); i++)
+    {
+      index_[s.debtors[i]]->addRecurrence(payer, rule);
+    }
+  for (size_t i = 0; i < s.groups.size(); i++)
+    {
+      findGroup(s.groups[i])->chargeRecurring(payer, rule, s.skipped[i]);
+    }
+  return OK;
+}
+
+//Works out who owes a share of a payment: every person named, and every member
+//of every group named, each only once. If missing is given, it is set to the
+//name of any person or group which does not exist.
+Ledger::Status Ledger::split(const Payees & payees, Split & split, std::string * missing) const
+{
+  std::vector<std::string> & debtors = split.debtors;
+  debtors.clear();
+  split.groups.clear();
+  split.skipped.clear();
+  for (size_t i = 0; i < payees.entries().size(); i++)
+    {
+      const Payees::Entry & e = payees.entries()[i];
+      if (e.group)
+	{
+	  const Group * g = group(e.name);
+	  if (g == NULL)
+	    {
+	      if (missing != NULL) *missing = e.name;
+	      return NO_SUCH_GROUP;
+	    }
+	  debtors.insert(debtors.end(), g->persons().begin(), g->persons().end());
+	  if (std::find(split.groups.begin(), split.groups.end(), e.name) != split.groups.end()) continue;
+
+	  //Members of a group named earlier already have their share charged there
+	  split.skipped.push_back(std::vector<std::string>());
+	  for (size_t j = 0; j < split.groups.size(); j++)
+	    {
+	      const Group * earlier = group(split.groups[j]);
+	      for (std::pmr::set<std::string>::const_iterator m = g->persons().begin(); m != g->persons().end(); m++)
+		{
+		  if (earlier->hasMember(*m)) split.skipped.back().push_back(*m);
+		}
+	    }
+	  std::sort(split.skipped.back().begin(), split.skipped.back().end());
+	  split.skipped.back().erase(std::unique(split.skipped.back().begin(), split.skipped.back().end()),
+				     split.skipped.back().end());
+	  split.groups.push_back(e.name);
+	}
+      else
+	{
+	  if (person(e.name) == NULL)
+	    {
+	      if (missing != NULL) *missing = e.name;
+	      return NO_SUCH_PERSON;
+	    }
+	  debtors.push_back(e.name);
+	}
+    }
+
+  //The amount is split evenly, so someone has to be paying
+  if (debtors.empty()) return NO_PAYEES;
+  std::sort(debtors.begin(), debtors.end());
+  debtors.erase(std::unique(debtors.begin(), debtors.end()), debtors.end());
+  return OK;
+}
+
+//Finds how much one person owes another, after what the other owes them
+//Repeating payments are counted up to today. If missing is given, it is set to
+//the name of whichever person does not exist.
+Ledger::Status Ledger::balance(const std::string & debtor, const std::string & creditor, Money & owed,
+			       std::string * missing) const
+{
+  const Person * a = person(debtor);
+  const Person * b = person(creditor);
+  if (a == NULL || b == NULL)
+    {
+      if (missing != NULL) *missing = a == NULL ? debtor : creditor;
+      return NO_SUCH_PERSON;
+    }
+  owed = Money(a->debt(creditor) - b->debt(debtor));
+  return OK;
+}
+
+//Finds how much one person owes everyone else put together, after what they are owed
+Ledger::Status Ledger::balance(const std::string & debtor, Money & owed) const
+{
+  const Person * a = person(debtor);
+  if (a == NULL) return NO_SUCH_PERSON;
+  int sum = a->totalDebt();
+  for (PersonList::const_iterator i = persons_.begin(); i != persons_.end(); i++)
+    {
+      sum -= i->debt(debtor);
+    }
+  owed = Money(sum);
+  return OK;
+}
+
+//Returns every recorded payment the debtor owes the creditor
+//Repeating payments are not included; occurrences() goes through those.
+//Empty if either does not exist.
+Ledger::History Ledger::history(const std::string & debtor, const std::string & creditor) const
+{
+  static const Person::History none;
+  const Person * a = person(debtor);
+  if (a == NULL || person(creditor) == NULL) return History(none);
+  return History(a->history(creditor));
+}
+
+//Returns every time a repeating payment the creditor makes for the debtor has
+//happened, up to today, each rule in the order it was added
+//Empty if either does not exist.
+Ledger::Occurrences Ledger::occurrences(const std::string & debtor, const std::string & creditor) const
+{
+  static const RuleList none;
+  const Person * a = person(debtor);
+  if (a == NULL || person(creditor) == NULL) return Occurrences(none, 0);
+  Person::Recurrences::const_iterator r = a->recurrences().find(creditor);
+  return Occurrences(r == a->recurrences().end() ? none : r->second, Recurrence::today());
+}
+
+//Moves on to the next rule which has happened, once this one is used up
+void Ledger::OccurrenceIterator::skip()
+{
+  if (n_ == 0 && rule_ != end_) count_ = rule_->count(day_);
+  while (rule_ != end_ && n_ >= count_)
+    {
+      ++rule_;
+      n_ = 0;
+      if (rule_ != end_) count_ = rule_->count(day_);
+    }
+}
+
+//Finds each person still in group All, by name
+std::map<std::string, const Person*> Ledger::live() const
+{
+  std::map<std::string, const Person*> index;
+  for (PersonList::const_iterator p = persons_.begin(); p != persons_.end(); p++)
+    {
+      if (all_->hasMember(p->name())) index[p->name()] = &(*p);
+    }
+  return index;
+}
+
+//Finds every pair of persons still in group All with something recorded between
+//them, each pair only once, visiting only pairs with history. A pair is given by
+//whichever of the two has an entry for the other, the first by name if both do.
+//With left, persons who have left All are included too.
+std::vector<Ledger::Pair> Ledger::pairs(bool left) const
+{
+  std::map<std::string, const Person*> index = live();
+  for (PersonList::const_iterator p = persons_.begin(); left && p != persons_.end(); p++)
+    {
+      index[p->name()] = &(*p);
+    }
+  std::vector<Pair> found;
+  for (std::map<std::string, const Person*>::iterator a = index.begin(); a != index.end(); a++)
+    {
+      //Everyone this person has a history or a repeating payment with, in name
+      //order, going through both maps together
+      const Person::Debts & debts = a->second->debts();
+      const Person::Recurrences & rules = a->second->recurrences();
+      Person::Debts::const_iterator d = debts.begin();
+      Person::Recurrences::const_iterator r = rules.begin();
+      while (d != debts.end() || r != rules.end())
+	{
+	  bool fromDebts = r == rules.end() || (d != debts.end() && d->first <= r->first);
+	  const std::string & payer = fromDebts ? d->first : r->first;
+
+	  std::map<std::string, const Person*>::iterator b = index.find(payer);
+	  if (b != index.end() && b != a)
+	    {
+	      const Person * other = b->second;
+	      if (a->first < b->first || (other->debts().find(a->first) == other->debts().end() &&
+					  other->recurrences().find(a->first) == other->recurrences().end()))
+		{
+		  found.push_back(Pair(a->second, other));
+		}
+	    }
+
+	  if (fromDebts && r != rules.end() && r->first == payer) r++;
+	  if (fromDebts) d++;
+	  else r++;
+	}
+    }
+  return found;
+}
+
+//Returns a short explanation of a status
+const char * Ledger::describe(Status status)
+{
+  switch (status)
+    {
+    case OK: return "OK";
+    case NAME_TAKEN: return "Name already in use";
+    case NO_SUCH_PERSON: return "Person does not exist";
+    case NO_SUCH_GROUP: return "Group does not exist";
+    case NOT_A_MEMBER: return "Person is not in the group";
+    case PROTECTED_GROUP: return "Group All cannot be changed";
+    case BAD_AMOUNT: return "Amount must not be 0";
+    case BAD_DATES: return "End date is before the start date";
+    case NO_PAYEES: return "Nobody to split the amount between";
+    }
+  return "Unknown status";
+}
+
+//Finds a person to change, remembering the name if there is none
+//Like person(), only members of All are found.
+Person * Ledger::findPerson(const std::string & name)
+{
+  PersonIndex::iterator p = index_.find(name);
+  if (p != index_.end() && all_->hasMember(name)) return p->second;
+  unknown_ = name;
+  return NULL;
+}
+
+//Finds a group to change, remembering the name if there is none
+Group * Ledger::findGroup(const std::string & name)
+{
+  for (GroupList::iterator g = groups_.begin(); g != groups_.end(); g++)
+    {
+      if (g->name() == name) return &(*g);
+    }
+  unknown_ = name;
+  return NULL;
+}
@@ -0,0 +1,231 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Ledger Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the header for a class holding every person and group and the debts
+  between them. It can be used directly by other programs, without going
+  through commands; mt is a front end to it.
+
+  Each ledger allocates from its own pools, so separate ledgers can be used on
+  separate threads. One ledger can be read by several threads at once through
+  its const functions, but nothing may change it while they do.
+*/
+
+#ifndef _ledger_h_
+#define _ledger_h_
+
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "group.h"
+#include "memory.h"
+#include "money.h"
+#include "person.h"
+#include "recurrence.h"
+
+//Who a payment is split between: persons and groups, in the order given
+class Payees
+{
+ public:
+  //One person, or every member of a group
+  struct Entry
+  {
+    std::string name;
+    bool group;
+  };
+
+  //Mutators
+  Payees & person(const std::string & name) {entries_.push_back(Entry{name, false}); return *this;}
+  Payees & group(const std::string & name) {entries_.push_back(Entry{name, true}); return *this;}
+
+  //Accessors
+  const std::vector<Entry> & entries() const {return entries_;}
+
+ private:
+  std::vector<Entry> entries_;
+};
+
+class Ledger
+{
+ public:
+  //The result of every change, and of queries which can fail
+  enum Status {OK, NAME_TAKEN, NO_SUCH_PERSON, NO_SUCH_GROUP, NOT_A_MEMBER, PROTECTED_GROUP,
+	       BAD_AMOUNT, BAD_DATES, NO_PAYEES};
+
+  //How a payment was split once groups were expanded: what each person owes,
+  //who owes it, and the groups it was charged through. A person in more than one
+  //of the groups only has their share charged to the first; for each group,
+  //skipped holds the members whose share went to an earlier one.
+  struct Split
+  {
+    Money each;
+    std::vector<std::string> debtors;
+    std::vector<std::string> groups;
+    std::vector<std::vector<std::string> > skipped;
+  };
+
+  //Two persons with a history or a repeating payment between them
+  typedef std::pair<const Person*, const Person*> Pair;
+
+  //One payment in a history, and the day it fell on if it was a repeating one
+  //Recorded payments have no date, so their day is Recurrence::NEVER.
+  struct Entry
+  {
+    std::string_view desc;
+    Money amount;
+    int day;
+  };
+
+  //The repeating payments one person makes for another
+  typedef std::pmr::list<Recurrence> RuleList;
+
+  //Goes through a history, giving each payment as an Entry
+  class HistoryIterator
+  {
+   public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef Entry value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Entry * pointer;
+    typedef Entry reference;
+
+    HistoryIterator(Person::History::const_iterator init) : it_(init) {}
+    Entry operator*() const {return Entry{it_->first, Money(it_->second), Recurrence::NEVER};}
+    HistoryIterator & operator++() {++it_; return *this;}
+    HistoryIterator operator++(int) {HistoryIterator old = *this; ++it_; return old;}
+    bool operator==(const HistoryIterator & other) const {return it_ == other.it_;}
+    bool operator!=(const HistoryIterator & other) const {return it_ != other.it_;}
+
+   private:
+    Person::History::const_iterator it_;
+  };
+
+  //Every payment one person owes another, for use in a range for
+  class History
+  {
+   public:
+    History(const Person::History & inlist) : list_(&inlist) {}
+    HistoryIterator begin() const {return HistoryIterator(list_->begin());}
+    HistoryIterator end() const {return HistoryIterator(list_->end());}
+    size_t size() const {return list_->size();}
+
+   private:
+    const Person::History * list_;
+  };
+
+  //Goes through repeating payments, giving each time one has happened up to a
+  //day as an Entry
+  class OccurrenceIterator
+  {
+   public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef Entry value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Entry * pointer;
+    typedef Entry reference;
+
+    OccurrenceIterator(RuleList::const_iterator init, RuleList::const_iterator inend, int inday) :
+      rule_(init), end_(inend), day_(inday), n_(0), count_(0) {skip();}
+    Entry operator*() const {return Entry{rule_->desc(), Money(rule_->amount()), rule_->date(n_)};}
+    OccurrenceIterator & operator++() {n_++; skip(); return *this;}
+    OccurrenceIterator operator++(int) {OccurrenceIterator old = *this; ++(*this); return old;}
+    bool operator==(const OccurrenceIterator & other) const {return rule_ == other.rule_ && n_ == other.n_;}
+    bool operator!=(const OccurrenceIterator & other) const {return !(*this == other);}
+
+   private:
+    //Moves on to the next rule which has happened, once this one is used up
+    void skip();
+
+    RuleList::const_iterator rule_;
+    RuleList::const_iterator end_;
+    int day_;
+    int n_;
+    int count_;
+  };
+
+  //Every time one person's repeating payments for another have happened up to
+  //today, for use in a range for. Kept apart from History, since these are
+  //worked out from each rule as they are visited rather than stored.
+  class Occurrences
+  {
+   public:
+    Occurrences(const RuleList & inlist, int inday) : list_(&inlist), day_(inday) {}
+    OccurrenceIterator begin() const {return OccurrenceIterator(list_->begin(), list_->end(), day_);}
+    OccurrenceIterator end() const {return OccurrenceIterator(list_->end(), list_->end(), day_);}
+
+   private:
+    const RuleList * list_;
+    int day_;
+  };
+
+  //Constructors
+  Ledger();
+
+  //Accessors
+  const GroupList & groups() const {return groups_;}
+  const PersonList & persons() const {return persons_;}
+  const Group & all() const {return *all_;}
+  const Memory & memory() const {return memory_;}
+  const Person * person(const std::string & name) const;
+  const Group * group(const std::string & name) const;
+  const std::string & unknown() const {return unknown_;}
+
+  //Mutators
+  Status addPerson(const std::string & name);
+  Status removePerson(const std::string & name);
+  Status addGroup(const std::string & name);
+  Status removeGroup(const std::string & name);
+  Status join(const std::string & groupName, const std::string & personName);
+  Status leave(const std::string & groupName, const std::string & personName);
+  Status addTransaction(const std::string & payer, Money amount, const std::string & desc,
+			const Payees & payees, Split * split = NULL);
+  Status addRecurring(const std::string & payer, Money amount, const std::string & desc,
+		      Recurrence::Period period, int start, int end, const Payees & payees, Split * split = NULL);
+
+  //General use functions
+  Status split(const Payees & payees, Split & split, std::string * missing = NULL) const;
+  Status balance(const std::string & debtor, const std::string & creditor, Money & owed,
+		 std::string * missing = NULL) const;
+  Status balance(const std::string & debtor, Money & owed) const;
+  History history(const std::string & debtor, const std::string & creditor) const;
+  Occurrences occurrences(const std::string & debtor, const std::string & creditor) const;
+  std::map<std::string, const Person*> live() const;
+  std::vector<Pair> pairs(bool left = false) const;
+  static const char * describe(Status status);
+
+ private:
+  //Not copyable, since the index points into the lists
+  Ledger(const Ledger &);
+  Ledger & operator=(const Ledger &);
+
+  //Lookups which remember the name if it is not found
+  Person * findPerson(const std::string & name);
+  Group * findGroup(const std::string & name);
+
+  //The pools everything below is allocated from, so it has to come first
+  Memory memory_;
+
+  //Every group, starting with All, and every person, each in their own pool
+  GroupList groups_;
+  PersonList persons_;
+  Group * all_;
+
+  //Each person by name, kept in the person pool
+  //The names are the persons' own, so the index holds no copies of them.
+  typedef std::pmr::unordered_map<std::string_view, Person*> PersonIndex;
+  PersonIndex index_;
+
+  //The name the last failed change could not find
+  std::string unknown_;
+};
+
+#endif
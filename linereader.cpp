@@ -0,0 +1,115 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Line Reader Implementation File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the implementation of the LineReader class
+*/
+
+#include <cstring>
+#include "linereader.h"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+//Returns true if the file is an interactive terminal
+bool isTerminal(FILE * file)
+{
+#ifdef _WIN32
+  return _isatty(_fileno(file)) != 0;
+#else
+  return isatty(fileno(file)) != 0;
+#endif
+}
+
+//Reads whatever is available, up to size bytes, without waiting for more
+//Returns the number of bytes read, or 0 at the end of the file or on an error
+static size_t readSome(FILE * file, char * buf, size_t size)
+{
+#ifdef _WIN32
+  int got = _read(_fileno(file), buf, unsigned(size));
+#else
+  ssize_t got = read(fileno(file), buf, size);
+#endif
+  return got > 0 ? size_t(got) : 0;
+}
+
+//Standard use constructor, which starts reading right away
+LineReader::LineReader(FILE * infile, size_t inbufsize, size_t inbatches) :
+  shared_(std::make_shared<Shared>(infile, inbatches)), done_(false)
+{
+  thread_ = std::thread(run, shared_, inbufsize);
+}
+
+//Waits for the thread if all of its input was used; otherwise it may be stuck
+//waiting for more, so it is told to stop and left to finish on its own
+LineReader::~LineReader()
+{
+  if (done_)
+    {
+      thread_.join();
+    }
+  else
+    {
+      shared_->queue.close();
+      thread_.detach();
+    }
+}
+
+//Waits for the next batch of lines
+//Returns false once the end of input has already been handed over
+bool LineReader::next(LineBatch & batch)
+{
+  if (done_) return false;
+  shared_->queue.pop(batch);
+  done_ = batch.end;
+  return true;
+}
+
+//Reads the file a buffer at a time, splitting each into lines and tokens
+void LineReader::run(std::shared_ptr<Shared> shared, size_t bufsize)
+{
+  std::vector<char> buf(bufsize);
+  std::string line;
+  int total = 0;
+  bool end = false;
+
+  while (!end)
+    {
+      size_t got = readSome(shared->file, &buf[0], buf.size());
+      end = got == 0;
+
+      LineBatch batch;
+      batch.end = end;
+      size_t start = 0;
+      while (start < got || (end && !line.empty()))
+	{
+	  //Find the end of this line, keeping any unfinished line for the next buffer
+	  const char * newline = end ? NULL : (const char *)memchr(&buf[start], '\n', got - start);
+	  if (newline == NULL && !end)
+	    {
+	      line.append(&buf[start], got - start);
+	      break;
+	    }
+	  size_t length = newline == NULL ? 0 : newline - &buf[start];
+	  line.append(&buf[start], length);
+	  start += length + 1;
+
+	  total++;
+	  batch.lines.push_back(SourceLine());
+	  batch.lines.back().number = total;
+	  tokenize(line, batch.lines.back().tokens);
+	  if (batch.lines.back().tokens.empty()) batch.lines.pop_back();
+	  line.clear();
+	}
+      batch.total = total;
+
+      //Hand it over, unless nobody wants it any more
+      if (!shared->queue.push(batch)) return;
+    }
+}
@@ -0,0 +1,68 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Line Reader Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the header for a class which reads and tokenizes input on its own
+  thread, handing over batches of lines while earlier ones are being run.
+*/
+
+#ifndef _linereader_h_
+#define _linereader_h_
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "loader.h"
+#include "spscqueue.h"
+
+//The lines read from one buffer, leaving out empty ones
+//total is how many lines have been read so far, empty or not
+struct LineBatch
+{
+  std::vector<SourceLine> lines;
+  int total;
+  bool end;
+};
+
+//Returns true if the file is an interactive terminal
+bool isTerminal(FILE * file);
+
+class LineReader
+{
+ public:
+  //Constructors
+  LineReader(FILE * infile, size_t inbufsize = 1 << 20, size_t inbatches = 16);
+  ~LineReader();
+
+  //General use functions
+  bool next(LineBatch & batch);
+
+ private:
+  //Not copyable, since it owns the thread
+  LineReader(const LineReader &);
+  LineReader & operator=(const LineReader &);
+
+  //Everything the reading thread uses, which it keeps alive if it is left behind
+  struct Shared
+  {
+    Shared(FILE * infile, size_t inbatches) : file(infile), queue(inbatches) {}
+    FILE * file;
+    SpscQueue<LineBatch> queue;
+  };
+
+  //Body of the reading thread
+  static void run(std::shared_ptr<Shared> shared, size_t bufsize);
+
+  std::shared_ptr<Shared> shared_;
+  std::thread thread_;
+
+  //Set once the last batch has been handed over
+  bool done_;
+};
+
+#endif
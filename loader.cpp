@@ -0,0 +1,163 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Loader Implementation File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the implementation for a class which reads transaction files ahead
+  of time on other threads and catches files loading themselves.
+*/
+
+#include "loader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+//Splits a line on spaces, dropping empty tokens and line returns
+//If columns is given, it is filled in with the column each token started at.
+void tokenize(const std::string & line, std::vector<std::string> & tokens, std::vector<int> * columns)
+{
+  tokens.clear();
+  if (columns != NULL) columns->clear();
+  size_t start = 0;
+  while (start <= line.size())
+    {
+      size_t end = line.find(' ', start);
+      if (end == std::string::npos) end = line.size();
+      if (end > start && !(end - start == 1 && line[start] == '\r'))
+	{
+	  tokens.emplace_back(line, start, end - start);
+	  if (columns != NULL) columns->push_back(start + 1);
+	}
+      start = end + 1;
+    }
+
+  //Remove trailing \r
+  if (tokens.size() > 0 && tokens.back().find('\r') != std::string::npos)
+    {
+      tokens.back().erase(tokens.back().find('\r'), 1);
+    }
+}
+
+//Reads a whole file and splits it into lines of tokens
+//Safe to call from any thread
+SourceFile Loader::read(const std::string & path)
+{
+  SourceFile file;
+  file.path = path;
+
+  //Note what it looked like first, so a later change is noticed even mid-read
+  stamp(path, file.size, file.modified);
+  std::ifstream fin(path.c_str(), std::ifstream::in | std::ifstream::binary);
+  file.opened = bool(fin);
+  if (!file.opened) return file;
+
+  std::stringstream contents;
+  contents << fin.rdbuf();
+  std::string text = contents.str();
+
+  //Keep every line with something on it, remembering where it was
+  size_t start = 0;
+  int number = 0;
+  std::vector<std::string> tokens;
+  while (start < text.size())
+    {
+      size_t end = text.find('\n', start);
+      if (end == std::string::npos) end = text.size();
+      number++;
+      tokenize(text.substr(start, end - start), tokens);
+      if (tokens.size() > 0)
+	{
+	  file.lines.push_back(SourceLine());
+	  file.lines.back().number = number;
+	  file.lines.back().tokens.swap(tokens);
+	}
+      start = end + 1;
+    }
+
+  return file;
+}
+
+//Starts reading the files this one loads from the given line on, each on its own
+//thread, until there are as many being read as the machine has cores
+//Returns the line to carry on from once some have been taken.
+size_t Loader::prefetch(const SourceFile & file, size_t from)
+{
+  size_t limit = std::max(2u, std::thread::hardware_concurrency());
+  size_t i;
+  for (i = from; i < file.lines.size() && pending_.size() < limit; i++)
+    {
+      const std::vector<std::string> & tokens = file.lines[i].tokens;
+      if (tokens.size() != 2 || tokens[0] != "load" || pending_.count(tokens[1]) > 0) continue;
+      Pending & p = pending_[tokens[1]];
+      p.depth = stack_.size();
+      p.file = std::async(std::launch::async, &Loader::read, tokens[1]);
+    }
+  return i;
+}
+
+//Returns a file, waiting for it if it is already being read, or reading it now if
+//not. A file which has changed since it was read ahead is read again.
+SourceFile Loader::take(const std::string & path)
+{
+  std::map<std::string, Pending>::iterator p = pending_.find(path);
+  if (p == pending_.end()) return read(path);
+
+  SourceFile file = p->second.file.get();
+  pending_.erase(p);
+  uintmax_t size;
+  std::filesystem::file_time_type modified;
+  if (!stamp(path, size, modified) || !file.opened || size != file.size || modified != file.modified)
+    {
+      return read(path);
+    }
+  return file;
+}
+
+//Marks a file as being loaded
+//Returns false if it is already being loaded, since loading it again would never end
+bool Loader::enter(const std::string & path)
+{
+  std::string k = key(path);
+  for (size_t i = 0; i < stack_.size(); i++)
+    {
+      if (stack_[i] == k) return false;
+    }
+  stack_.push_back(k);
+  return true;
+}
+
+//Drops every file read ahead for the file being loaded, or for anything it
+//loaded, which was never taken because it stopped early
+void Loader::abandon()
+{
+  std::map<std::string, Pending>::iterator p = pending_.begin();
+  while (p != pending_.end())
+    {
+      if (p->second.depth >= stack_.size()) p = pending_.erase(p);
+      else p++;
+    }
+}
+
+//Returns a name for a file which is the same however the path was written
+std::string Loader::key(const std::string & path)
+{
+  std::error_code ec;
+  std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+  return ec ? path : canonical.string();
+}
+
+//Finds the size and modification time of a file
+//Returns false if it cannot be found.
+bool Loader::stamp(const std::string & path, uintmax_t & size, std::filesystem::file_time_type & modified)
+{
+  std::error_code ec;
+  size = std::filesystem::file_size(path, ec);
+  if (ec) return false;
+  modified = std::filesystem::last_write_time(path, ec);
+  return !ec;
+}
@@ -0,0 +1,76 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Loader Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the header for a class which reads transaction files ahead of time
+  on other threads and catches files loading themselves.
+*/
+
+#ifndef _loader_h_
+#define _loader_h_
+
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <string>
+#include <vector>
+
+//One line of a file, split into tokens
+struct SourceLine
+{
+  int number;
+  std::vector<std::string> tokens;
+};
+
+//A whole file, split into lines, with its size and modification time when it was read
+struct SourceFile
+{
+  std::string path;
+  bool opened;
+  uintmax_t size;
+  std::filesystem::file_time_type modified;
+  std::vector<SourceLine> lines;
+};
+
+//Splits a line on spaces, dropping empty tokens and line returns
+//If columns is given, it is filled in with the column each token started at.
+void tokenize(const std::string & line, std::vector<std::string> & tokens, std::vector<int> * columns = NULL);
+
+class Loader
+{
+ public:
+  //General use functions
+  static SourceFile read(const std::string & path);
+  size_t prefetch(const SourceFile & file, size_t from);
+  SourceFile take(const std::string & path);
+
+  //Keeping track of which files are being loaded
+  bool enter(const std::string & path);
+  void abandon();
+  void leave() {stack_.pop_back();}
+  static std::string key(const std::string & path);
+
+ private:
+  //Helpers
+  static bool stamp(const std::string & path, uintmax_t & size, std::filesystem::file_time_type & modified);
+
+  //A file being read on another thread, and how deep the file loading it was
+  struct Pending
+  {
+    size_t depth;
+    std::future<SourceFile> file;
+  };
+
+  //Files being read on other threads, by the name they were loaded with
+  std::map<std::string, Pending> pending_;
+
+  //The files being loaded right now, innermost last
+  std::vector<std::string> stack_;
+};
+
+#endif
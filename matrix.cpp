@@ -0,0 +1,136 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Matrix Implementation File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the implementation for a class holding what each member of a group
+  owes each other member, built in one pass over their debts.
+*/
+
+#include "matrix.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include "money.h"
+
+//Builds the matrix for a group, visiting each member's debts once
+DebtMatrix::DebtMatrix(const Group & group, const Ledger & ledger, int day) :
+  names_(group.persons().begin(), group.persons().end()), dense_(names_.size() <= size_t(DENSE_LIMIT))
+{
+  if (dense_) table_.assign(names_.size() * names_.size(), 0);
+
+  std::map<std::string, int> index;
+  for (size_t i = 0; i < names_.size(); i++) index[names_[i]] = i;
+
+  for (std::map<std::string, int>::iterator debtor = index.begin(); debtor != index.end(); debtor++)
+    {
+      const Person * p = ledger.person(debtor->first);
+      if (p == NULL) continue;
+
+      for (Person::Debts::const_iterator d = p->debts().begin(); d != p->debts().end(); d++)
+	{
+	  std::map<std::string, int>::iterator creditor = index.find(d->first);
+	  if (creditor == index.end() || creditor == debtor) continue;
+	  add(debtor->second, creditor->second, p->historyDebt(d->first));
+	}
+      for (Person::Recurrences::const_iterator r = p->recurrences().begin(); r != p->recurrences().end(); r++)
+	{
+	  std::map<std::string, int>::iterator creditor = index.find(r->first);
+	  if (creditor == index.end() || creditor == debtor) continue;
+	  add(debtor->second, creditor->second, p->recurringDebt(r->first, day));
+	}
+    }
+}
+
+//Returns what one member owes another, after what the other owes them
+int DebtMatrix::owed(int debtor, int creditor) const
+{
+  if (dense_) return table_[debtor * names_.size() + creditor];
+
+  std::map<std::pair<int,int>, int>::const_iterator i =
+    pairs_.find(debtor < creditor ? std::make_pair(debtor, creditor) : std::make_pair(creditor, debtor));
+  if (i == pairs_.end()) return 0;
+  return debtor < creditor ? i->second : -i->second;
+}
+
+//Adds to what one member owes another, and takes it off the other way around
+void DebtMatrix::add(int debtor, int creditor, int cents)
+{
+  if (cents == 0) return;
+  if (dense_)
+    {
+      table_[debtor * names_.size() + creditor] += cents;
+      table_[creditor * names_.size() + debtor] -= cents;
+      return;
+    }
+
+  if (debtor < creditor) pairs_[std::make_pair(debtor, creditor)] += cents;
+  else pairs_[std::make_pair(creditor, debtor)] -= cents;
+}
+
+//Prints the matrix for reading: a grid for small groups, or each pair that owes
+//something for large ones
+void DebtMatrix::printTable(std::ostream & out) const
+{
+  if (!dense_)
+    {
+      for (std::map<std::pair<int,int>, int>::const_iterator i = pairs_.begin(); i != pairs_.end(); i++)
+	{
+	  if (i->second == 0) continue;
+	  int debtor = i->second > 0 ? i->first.first : i->first.second;
+	  int creditor = i->second > 0 ? i->first.second : i->first.first;
+	  out << names_[debtor] << " owes " << names_[creditor] << " $" << Money(abs(i->second)).str() << ".\n";
+	}
+      return;
+    }
+
+  //Each row is what that person owes each column
+  size_t width = 10;
+  for (size_t i = 0; i < names_.size(); i++) width = std::max(width, names_[i].size() + 1);
+
+  out << std::setw(width) << "owes:";
+  for (size_t j = 0; j < names_.size(); j++) out << std::setw(width) << names_[j];
+  out << '\n';
+  for (size_t i = 0; i < names_.size(); i++)
+    {
+      out << std::setw(width) << names_[i];
+      for (size_t j = 0; j < names_.size(); j++)
+	{
+	  if (i == j) out << std::setw(width) << "-";
+	  else out << std::setw(width) << Money(table_[i * names_.size() + j]).str();
+	}
+      out << '\n';
+    }
+}
+
+//Prints the matrix as CSV: the full grid for small groups, or a row for each
+//pair that owes something for large ones
+void DebtMatrix::printCSV(std::ostream & out) const
+{
+  if (!dense_)
+    {
+      out << "debtor,creditor,amount\n";
+      for (std::map<std::pair<int,int>, int>::const_iterator i = pairs_.begin(); i != pairs_.end(); i++)
+	{
+	  if (i->second == 0) continue;
+	  int debtor = i->second > 0 ? i->first.first : i->first.second;
+	  int creditor = i->second > 0 ? i->first.second : i->first.first;
+	  out << names_[debtor] << ',' << names_[creditor] << ',' << Money(abs(i->second)).str() << '\n';
+	}
+      return;
+    }
+
+  out << "debtor";
+  for (size_t j = 0; j < names_.size(); j++) out << ',' << names_[j];
+  out << '\n';
+  for (size_t i = 0; i < names_.size(); i++)
+    {
+      out << names_[i];
+      for (size_t j = 0; j < names_.size(); j++) out << ',' << Money(table_[i * names_.size() + j]).str();
+      out << '\n';
+    }
+}
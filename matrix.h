@@ -0,0 +1,57 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Matrix Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the header for a class holding what each member of a group owes
+  each other member, built in one pass over their debts.
+*/
+
+#ifndef _matrix_h_
+#define _matrix_h_
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "group.h"
+#include "ledger.h"
+#include "person.h"
+
+class DebtMatrix
+{
+ public:
+  //Groups up to this size are stored as a full table, larger ones only keep nonzero pairs
+  static const int DENSE_LIMIT = 64;
+
+  //Constructors
+  DebtMatrix(const Group & group, const Ledger & ledger, int day);
+
+  //Accessors
+  int size() const {return names_.size();}
+  bool dense() const {return dense_;}
+  const std::string & name(int i) const {return names_[i];}
+  int owed(int debtor, int creditor) const;
+
+  //General use functions
+  void printTable(std::ostream & out) const;
+  void printCSV(std::ostream & out) const;
+
+ private:
+  //Adds to what one member owes another, and takes it off the other way around
+  void add(int debtor, int creditor, int cents);
+
+  //The members, in name order; a member's index is their row and column
+  std::vector<std::string> names_;
+
+  //Net amounts owed: a full table for small groups, or only the nonzero pairs
+  //(smaller index first) for large ones
+  bool dense_;
+  std::vector<int> table_;
+  std::map<std::pair<int,int>, int> pairs_;
+};
+
+#endif
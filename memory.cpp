@@ -0,0 +1,61 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Memory Implementation File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the implementation of the memory pools the persons, groups and
+  histories are allocated from.
+*/
+
+#include "memory.h"
+
+//Standard use constructor
+TrackingResource::TrackingResource(std::pmr::memory_resource * inupstream) :
+  upstream_(inupstream), bytes_(0), blocks_(0), peak_(0) {}
+
+//Takes memory from upstream and counts it
+void * TrackingResource::do_allocate(size_t bytes, size_t alignment)
+{
+  void * p = upstream_->allocate(bytes, alignment);
+  bytes_ += bytes;
+  blocks_++;
+  if (bytes_ > peak_) peak_ = bytes_;
+  return p;
+}
+
+//Gives memory back upstream and stops counting it
+void TrackingResource::do_deallocate(void * p, size_t bytes, size_t alignment)
+{
+  upstream_->deallocate(p, bytes, alignment);
+  bytes_ -= bytes;
+  blocks_--;
+}
+
+//Standard use constructor
+MemoryPool::MemoryPool(const char * inname) :
+  name_(inname), reserved_(std::pmr::new_delete_resource()), pool_(&reserved_), used_(&pool_) {}
+
+//Standard use constructor
+Memory::Memory() :
+  persons_("persons"), groups_("groups"), membership_("membership"), totals_("group totals"),
+  histories_("histories"), descriptions_("descriptions"), stored_(descriptions_.resource()),
+  index_(descriptions_.resource()) {}
+
+//Returns the stored copy of a description, storing it if it is new
+//A tx stores the same description once per payee, so the last one is remembered
+std::string_view Memory::intern(const std::string & desc)
+{
+  if (last_ == desc) return last_;
+
+  std::pmr::unordered_set<std::string_view>::iterator i = index_.find(desc);
+  if (i == index_.end())
+    {
+      stored_.emplace_back(desc);
+      i = index_.insert(stored_.back()).first;
+    }
+  last_ = *i;
+  return last_;
+}
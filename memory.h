@@ -0,0 +1,128 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Memory Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the header for the memory pools the persons, groups and histories
+  are allocated from, which also count how much each of them uses. Each ledger
+  has its own set, so separate ledgers share nothing.
+*/
+
+#ifndef _memory_h_
+#define _memory_h_
+
+#include <cstddef>
+#include <deque>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+//Passes allocations through to another resource, counting them as it goes
+class TrackingResource : public std::pmr::memory_resource
+{
+ public:
+  //Constructors
+  TrackingResource(std::pmr::memory_resource * inupstream);
+
+  //Accessors
+  size_t bytes() const {return bytes_;}
+  size_t blocks() const {return blocks_;}
+  size_t peak() const {return peak_;}
+
+ private:
+  //memory_resource interface
+  void * do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void * p, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override {return this == &other;}
+
+  //Where the memory really comes from
+  std::pmr::memory_resource * upstream_;
+
+  //What is currently handed out, and the most there has ever been
+  size_t bytes_;
+  size_t blocks_;
+  size_t peak_;
+};
+
+//A pool for one kind of structure, which reuses freed blocks rather than
+//going back to the heap for every node
+class MemoryPool
+{
+ public:
+  //Constructors
+  MemoryPool(const char * inname);
+
+  //Accessors
+  const char * name() const {return name_;}
+  std::pmr::memory_resource * resource() {return &used_;}
+  const TrackingResource & used() const {return used_;}
+  const TrackingResource & reserved() const {return reserved_;}
+
+ private:
+  //Not copyable, since containers point at it
+  MemoryPool(const MemoryPool &);
+  MemoryPool & operator=(const MemoryPool &);
+
+  //What this pool is for
+  const char * name_;
+
+  //Heap memory the pool has taken, the pool itself, and what containers took from it
+  TrackingResource reserved_;
+  std::pmr::unsynchronized_pool_resource pool_;
+  TrackingResource used_;
+};
+
+//The pools for each structure of one ledger, and the one copy of each payment
+//description its histories refer to
+class Memory
+{
+ public:
+  //Constructors
+  Memory();
+
+  //Accessors
+  MemoryPool & persons() {return persons_;}
+  MemoryPool & groups() {return groups_;}
+  MemoryPool & membership() {return membership_;}
+  MemoryPool & totals() {return totals_;}
+  MemoryPool & histories() {return histories_;}
+  MemoryPool & descriptions() {return descriptions_;}
+  const MemoryPool & persons() const {return persons_;}
+  const MemoryPool & groups() const {return groups_;}
+  const MemoryPool & membership() const {return membership_;}
+  const MemoryPool & totals() const {return totals_;}
+  const MemoryPool & histories() const {return histories_;}
+  const MemoryPool & descriptions() const {return descriptions_;}
+  size_t descriptionCount() const {return stored_.size();}
+
+  //General use functions
+  std::string_view intern(const std::string & desc);
+
+ private:
+  //Not copyable, since containers point at the pools
+  Memory(const Memory &);
+  Memory & operator=(const Memory &);
+
+  //The pools, which have to outlive everything allocated from them
+  MemoryPool persons_;
+  MemoryPool groups_;
+  MemoryPool membership_;
+  MemoryPool totals_;
+  MemoryPool histories_;
+  MemoryPool descriptions_;
+
+  //Every description seen so far, and an index to find them by
+  //Descriptions are never removed, since any history may still refer to them.
+  //A deque never moves its elements, so the index can point into them.
+  std::pmr::deque<std::pmr::string> stored_;
+  std::pmr::unordered_set<std::string_view> index_;
+
+  //The description stored last
+  std::string_view last_;
+};
+
+#endif
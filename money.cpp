@@ -0,0 +1,22 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Money Implementation File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the implementation of the Money class
+*/
+
+#include "money.h"
+#include <cstdio>
+
+//Formats the amount as a number the tx command will read back exactly, such as 12.05
+std::string Money::str() const
+{
+  char buf[32];
+  unsigned int whole = cents_ < 0 ? -(unsigned int)cents_ : cents_;
+  sprintf(buf, "%s%u.%02u", cents_ < 0 ? "-" : "", whole / 100, whole % 100);
+  return buf;
+}
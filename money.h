@@ -0,0 +1,42 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Money Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the header for a class holding an amount of money as a whole
+  number of cents, so amounts add up exactly.
+*/
+
+#ifndef _money_h_
+#define _money_h_
+
+#include <string>
+
+class Money
+{
+ public:
+  //Constructors
+  explicit Money(int incents = 0) : cents_(incents) {}
+
+  //Accessors
+  int cents() const {return cents_;}
+  std::string str() const;
+
+  //General use functions
+  Money split(int ways) const {return Money(cents_ / ways);}
+  Money operator+(Money other) const {return Money(cents_ + other.cents_);}
+  Money operator-(Money other) const {return Money(cents_ - other.cents_);}
+  Money operator-() const {return Money(-cents_);}
+  bool operator==(Money other) const {return cents_ == other.cents_;}
+  bool operator!=(Money other) const {return cents_ != other.cents_;}
+  bool operator<(Money other) const {return cents_ < other.cents_;}
+
+ private:
+  //The amount, in cents
+  int cents_;
+};
+
+#endif
@@ -10,668 +10,1079 @@
   how much each person owes each other person.
 */
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <iomanip>
 #include <list>
 #include <sstream>
 #include <vector>
+#include <set>
 #include <cstdlib>
+#include <cstdio>
+#include "checker.h"
+#include "exporter.h"
 #include "group.h"
+#include "ledger.h"
+#include "linereader.h"
+#include "loader.h"
+#include "matrix.h"
+#include "memory.h"
 #include "person.h"
 
-const int MAX_INPUT_LENGTH = 200;
-
 //List iterators
-typedef std::list<Person>::iterator personIt;
-typedef std::list<Group>::iterator groupIt;
+typedef PersonList::const_iterator personIt;
+typedef GroupList::const_iterator groupIt;
+
+//The file the current state was read from, used by compact
+//Set by the command line or by a load typed at the terminal
+std::string ledgerFile;
+
+//Set while compact replays the start of the ledger file, which only needs the
+//commands that change the ledger
+bool replaying = false;
+
+//Reads loaded files ahead of time
+Loader loader;
 
-//Takes the list of all persons and a person and returns a number saying how much
-//total debt everyone owes that person.
-int debtTo(std::list<Person>& persons, std::string p)
+//Returns what one person owes another that will never change again: recorded
+//payments plus repeating payments which have reached their end date
+int settledDebt(const Person & person, const std::string & payer, int day)
 {
-  int sum = 0;
-  for (std::list<Person>::iterator i = persons.begin(); i != persons.end(); i++)
+  int sum = person.historyDebt(payer);
+  Person::Recurrences::const_iterator r = person.recurrences().find(payer);
+  if (r == person.recurrences().end()) return sum;
+  for (std::pmr::list<Recurrence>::const_iterator i = r->second.begin(); i != r->second.end(); i++)
     {
-      sum += i->debt(p);
+      if (i->end() <= day) sum += i->owed(day);
     }
-
   return sum;
 }
 
-//Takes a given input stream and parses it, modifying the provided lists
-//Reads until EOF is found. This will assume an "All" group already exists.
-//Returns 0 if it succeeded, returns 1 otherwise.
-int parseInput(std::istream & input, std::list<Group> & groups, std::list<Person> & persons)
+//Writes commands which recreate the given state from scratch: every person,
+//every group with its members, one tx settling each nonzero pair of persons,
+//and each repeating payment which has not yet ended. Persons who have left
+//group All are written like the rest, and leave it again at the end.
+//Returns the number of balancing transactions written.
+int writeCompacted(std::ostream & out, const Ledger & ledger)
 {
-  //Set up some variables
-  int lineNum = 0;
+  const GroupList & groups = ledger.groups();
+  const PersonList & persons = ledger.persons();
+  const Group * all = &ledger.all();
 
-  //Get an iterator to group All
-  groupIt all;
-  for (all = groups.begin(); all != groups.end(); all++)
+  //Persons, by name
+  std::map<std::string, const Person*> everyone;
+  for (personIt p = persons.begin(); p != persons.end(); p++)
     {
-      if (all->name() == "All") break;
+      everyone[p->name()] = &(*p);
     }
-  
-  //Read until EOF
-  while (!input.eof())
+  for (std::map<std::string, const Person*>::iterator p = everyone.begin(); p != everyone.end(); p++)
     {
-      //If reading from terminal, place a prompt
-      if (input == std::cin) std::cout << "> ";
+      out << "person " << p->first << '\n';
+    }
 
-      //Increment lineNum
-      lineNum++;
-      
-      //Get lines one at a time
-      char buf[MAX_INPUT_LENGTH];
-      input.getline(buf, MAX_INPUT_LENGTH);
-      std::stringstream lineInput(buf);
+  //Groups, with all their members joined at once
+  for (groupIt g = groups.begin(); g != groups.end(); g++)
+    {
+      if (&(*g) == all) continue;
+      out << "group " << g->name() << '\n';
+      if (g->size() == 0) continue;
 
-      //Now parse the individual line
-      std::string item;
-      std::vector<std::string> tokens;
-      while (std::getline(lineInput, item, ' '))
+      out << "join " << g->name();
+      for (std::pmr::set<std::string>::const_iterator i = g->persons().begin(); i != g->persons().end(); i++)
 	{
-	  tokens.push_back(item);
+	  out << ' ' << (*i);
 	}
+      out << '\n';
+    }
+
+  //One tx per pair that still owes something
+  int day = Recurrence::today();
+  int written = 0;
+  std::vector<Ledger::Pair> pairs = ledger.pairs(true);
+  for (size_t i = 0; i < pairs.size(); i++)
+    {
+      //Positive means a owes b, so b "pays" for a
+      const Person * a = pairs[i].first;
+      const Person * b = pairs[i].second;
+      int net = settledDebt(*a, b->name(), day) - settledDebt(*b, a->name(), day);
+      if (net > 0) out << "tx " << b->name() << ' ' << Money(net).str() << " Balance-forward " << a->name() << '\n';
+      else if (net < 0) out << "tx " << a->name() << ' ' << Money(-net).str() << " Balance-forward " << b->name() << '\n';
+      else continue;
+      written++;
+    }
 
-      //Erase all empty lines and windows line returns
-      for (std::vector<std::string>::iterator i = tokens.begin(); i != tokens.end();)
+  //Repeating payments carry on as they were
+  for (std::map<std::string, const Person*>::iterator a = everyone.begin(); a != everyone.end(); a++)
+    {
+      const Person::Recurrences & rules = a->second->recurrences();
+      for (Person::Recurrences::const_iterator r = rules.begin(); r != rules.end(); r++)
 	{
-	  if ((*i).size() == 0 || (*i) == "\r")
+	  if (r->first == a->first || everyone.find(r->first) == everyone.end()) continue;
+	  for (std::pmr::list<Recurrence>::const_iterator i = r->second.begin(); i != r->second.end(); i++)
 	    {
-	      i = tokens.erase(i);
+	      if (i->end() <= day) continue;
+	      out << "recur " << r->first << ' ' << Money(i->amount()).str() << ' ' << i->desc() << ' ' <<
+		Recurrence::periodName(i->period()) << ' ' << Recurrence::formatDate(i->start());
+	      if (i->end() != Recurrence::NEVER) out << " until " << Recurrence::formatDate(i->end());
+	      out << ' ' << a->first << '\n';
 	    }
-	  else
+	}
+    }
+
+  //Only now can those who had left All leave it again
+  for (std::map<std::string, const Person*>::iterator p = everyone.begin(); p != everyone.end(); p++)
+    {
+      if (!all->hasMember(p->first)) out << "leave All " << p->first << '\n';
+    }
+
+  return written;
+}
+
+//Reads the persons and "group GROUPNAME"s named from the given token on
+//Returns 0 if they were written correctly, 1 otherwise.
+int readPayees(const std::vector<std::string> & tokens, size_t first, Payees & payees, int lineNum)
+{
+  for (size_t i = first; i < tokens.size(); i++)
+    {
+      //If it is a group
+      if (tokens[i] == "group")
+	{
+	  i++;
+	  if (i == tokens.size())
 	    {
-	      i++;
+	      std::cerr << "ERROR: No group specified.\n" <<
+		"Stopped parsing at line " << lineNum << ".\n";
+	      return 1;
 	    }
+	  payees.group(tokens[i]);
 	}
+      else
+	{
+	  payees.person(tokens[i]);
+	}
+    }
 
-      //Empty line
-      if (tokens.size() == 0) continue;
+  return 0;
+}
+
+//Prints why a payment could not be added to the ledger
+//Returns 1, for the command to return.
+int paymentError(Ledger::Status status, const Ledger & ledger, int lineNum)
+{
+  if (status == Ledger::NO_SUCH_PERSON) std::cerr << "ERROR: Person " << ledger.unknown() << " does not exist.\n";
+  else if (status == Ledger::NO_SUCH_GROUP) std::cerr << "ERROR: Group " << ledger.unknown() << " does not exist.\n";
+  else if (status == Ledger::BAD_AMOUNT) std::cerr << "ERROR: Amount must be a number greater than 0.\n";
+  else if (status == Ledger::NO_PAYEES) std::cerr << "ERROR: Nobody to split the amount between.\n";
+  else std::cerr << "ERROR: " << Ledger::describe(status) << ".\n";
+  std::cerr << "Stopped parsing at line " << lineNum << ".\n";
+  return 1;
+}
+
+int runCommand(const std::vector<std::string> & tokens, int lineNum, bool fromTerminal, Ledger & ledger);
+int parseInput(std::istream & input, Ledger & ledger);
+
+//Runs each line of a file which has already been read in
+//Returns 0 if it succeeded, returns 1 otherwise.
+int runFile(const SourceFile & file, Ledger & ledger)
+{
+  //Start reading what it loads while this one runs, a few files at a time
+  size_t ahead = loader.prefetch(file, 0);
+
+  for (size_t i = 0; i < file.lines.size(); i++)
+    {
+      const std::vector<std::string> & tokens = file.lines[i].tokens;
+      int ret = runCommand(tokens, file.lines[i].number, false, ledger);
+      if (tokens[0] == "load") ahead = loader.prefetch(file, std::max(ahead, i + 1));
+      if (ret == 1) return 1;
+      if (ret == 2) return 0;
+    }
+
+  return 0;
+}
+
+//Loads a file and runs it
+//Returns 0 if it succeeded, 1 if it failed, 2 if it could not be opened, or 3 if
+//it is already being loaded.
+int loadFile(const std::string & path, Ledger & ledger)
+{
+  if (!loader.enter(path)) return 3;
+  SourceFile file = loader.take(path);
+  if (!file.opened)
+    {
+      loader.leave();
+      return 2;
+    }
+
+  int ret = runFile(file, ledger);
+  loader.abandon();
+  loader.leave();
+  return ret;
+}
+
+//Runs a single command which has already been split into tokens, modifying the
+//provided ledger.
+//Returns 0 if it succeeded, 1 if it failed, or 2 if the command was quit.
+int runCommand(const std::vector<std::string> & tokens, int lineNum, bool fromTerminal, Ledger & ledger)
+{
+  //Commands which only read the lists use them directly
+  const GroupList & groups = ledger.groups();
+  const PersonList & persons = ledger.persons();
+  const Group * all = &ledger.all();
+
+  //Comments are done by starting the line with a %
+  if (tokens[0][0] == '%')
+    {
+      //Do nothing
+    }
+
+  //A replay skips anything which only prints or writes files, including another compact
+  else if (replaying && (tokens[0] == "debt" || tokens[0] == "matrix" || tokens[0] == "compact" ||
+			 tokens[0] == "export" || tokens[0] == "mem" || tokens[0] == "info" ||
+			 tokens[0] == "help"))
+    {
+      //Do nothing
+    }
+
+  //group command: Create new group
+  //group GROUPNAME
+  else if (tokens[0] == "group")
+    {
+      //Verify line length
+      if (tokens.size() != 2)
+	{
+	  std::cerr << "ERROR: Group command only takes one argument.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //Add the group, unless the name is taken
+      if (ledger.addGroup(tokens[1]) == Ledger::NAME_TAKEN)
+	{
+	  std::cerr << "WARNING: Group name \"" << tokens[1] << "\" already in use.\n" <<
+	    "Warning occurred at line " << lineNum << ".\n";
+	}
+    }
 
-      //Remove trailing \r
-      if (tokens[tokens.size()-1].find('\r') != std::string::npos)
-        {
-          tokens[tokens.size()-1].erase(tokens[tokens.size()-1].find('\r'), 1);
-        }
+  //person command: Create new person
+  //person PERSONNAME
+  else if (tokens[0] == "person")
+    {
+      //Verify line length
+      if (tokens.size() != 2)
+	{
+	  std::cerr << "ERROR: Person command only takes one argument.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //Add the person and place them in the "All" group, unless the name is taken
+      if (ledger.addPerson(tokens[1]) == Ledger::NAME_TAKEN)
+	{
+	  std::cerr << "WARNING: Person name \"" << tokens[1] << "\" already in use.\n" <<
+	    "Warning occurred at line " << lineNum << ".\n";
+	}
+    }
 
-      //Comments are done by starting the line with a %
-      if (tokens[0][0] == '%')
+  //join command: Add people to a group
+  //join GROUPNAME PERSONNAME1 PERSONNAME2 ...
+  else if (tokens[0] == "join")
+    {
+      //Verify line length
+      if (tokens.size() < 3)
 	{
-	  //Do nothing
+	  std::cerr << "ERROR: Join command must have at least two arguments.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
 	}
 
-      //group command: Create new group
-      //group GROUPNAME
-      else if (tokens[0] == "group")
+      //Add each person, ensuring no duplicates
+      for (size_t i = 2; i < tokens.size(); i++)
 	{
-	  //Verify line length
-	  if (tokens.size() != 2)
+	  Ledger::Status status = ledger.join(tokens[1], tokens[i]);
+	  if (status == Ledger::NO_SUCH_GROUP)
 	    {
-	      std::cerr << "ERROR: Group command only takes one argument.\n" <<
+	      std::cerr << "ERROR: Group " << tokens[1] << " does not exist.\n" <<
 		"Stopped parsing at line " << lineNum << ".\n";
 	      return 1;
 	    }
-
-	  //Verify this group name is not taken
-	  bool taken = false;
-	  for (groupIt i = groups.begin(); i != groups.end(); i++)
+	  if (status == Ledger::NO_SUCH_PERSON)
 	    {
-	      if (i->name() == tokens[1])
-		{
-		  std::cerr << "WARNING: Group name \"" << tokens[1] << "\" already in use.\n" <<
-		    "Warning occurred at line " << lineNum << ".\n";
-		  taken = true;
-		}
+	      std::cerr << "ERROR: Person " << tokens[i] << " does not exist.\n" <<
+		"Stopped parsing at line " << lineNum << ".\n";
+	      return 1;
 	    }
+	}
+    }
 
-	  //Add the group!
-	  if (!taken) groups.push_back(Group(tokens[1]));
+  //leave command: Remove people from group
+  //leave GROUPNAME PERSONNAME1 PERSONNAME2 ...
+  else if (tokens[0] == "leave")
+    {
+      //Verify line length
+      if (tokens.size() < 3)
+	{
+	  std::cerr << "ERROR: Leave command must have at least two arguments.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
 	}
 
-      //person command: Create new person
-      //person PERSONNAME
-      else if (tokens[0] == "person")
+      //Remove each person!
+      for (size_t i = 2; i < tokens.size(); i++)
 	{
-	  //Verify line length
-	  if (tokens.size() != 2)
+	  Ledger::Status status = ledger.leave(tokens[1], tokens[i]);
+	  if (status == Ledger::NO_SUCH_GROUP)
+	    {
+	      std::cerr << "ERROR: Group " << tokens[1] << " does not exist.\n" <<
+		"Stopped parsing at line " << lineNum << ".\n";
+	      return 1;
+	    }
+	  if (status == Ledger::NOT_A_MEMBER)
 	    {
-	      std::cerr << "ERROR: Person command only takes one argument.\n" <<
+	      std::cerr << "ERROR: Person " <<
+		tokens[i] << " is not in group " << tokens[1] << ".\n" <<
 		"Stopped parsing at line " << lineNum << ".\n";
 	      return 1;
 	    }
+	}
+    }
+
+  //groupdel command: Delete a group
+  //groupdel GROUPNAME
+  else if (tokens[0] == "groupdel")
+    {
+      //Verify line length
+      if (tokens.size() != 2)
+	{
+	  std::cerr << "ERROR: Groupdel command only takes one argument.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
 
-	  //Verify this person name is not taken
-	  bool taken = false;
-	  if (all->hasMember(tokens[1]))
+      //Delete it
+      Ledger::Status status = ledger.removeGroup(tokens[1]);
+      if (status == Ledger::NO_SUCH_GROUP)
+	{
+	  std::cerr << "ERROR: Group " << tokens[1]<<" already does not exist.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      if (status == Ledger::PROTECTED_GROUP)
+	{
+	  std::cerr << "ERROR: Group " << tokens[1] << " cannot be deleted.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+    }
+  
+  //persondel command: Delete a person, also removing their debt
+  //persondel PERSONNAME
+  else if (tokens[0] == "persondel")
+    {
+      //Verify line length
+      if (tokens.size() != 2)
+	{
+	  std::cerr << "ERROR: Persondel command only takes one argument.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      
+      //Remove this person from all groups, and their debts with them
+      if (ledger.removePerson(tokens[1]) != Ledger::OK)
+	{
+	  std::cerr << "ERROR: Person " << tokens[1] << " already does not exist.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+    }
+  
+  //tx command: Record a transaction between persons
+  //tx PAYER AMOUNT CATEGORY PERSONNAME1 group GROUPNAME1 PERSONNAME2
+  else if (tokens[0] == "tx")
+    {
+      //Verify line length
+      if (tokens.size() < 5)
+	{
+	  std::cerr << "ERROR: tx command takes at least 5 arguments.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //Read who splits it, then split it evenly
+      Money amount(int((atof(tokens[2].c_str()) * 100.0) + 0.5));
+      Payees payees;
+      if (readPayees(tokens, 4, payees, lineNum) != 0) return 1;
+      Ledger::Status status = ledger.addTransaction(tokens[1], amount, tokens[3], payees);
+      if (status != Ledger::OK) return paymentError(status, ledger, lineNum);
+    }
+
+  //recur command: Record a payment repeating on a schedule, such as rent
+  //recur PAYER AMOUNT CATEGORY PERIOD START [until END] PERSONNAME1 group GROUPNAME1 ...
+  else if (tokens[0] == "recur")
+    {
+      //Verify line length
+      if (tokens.size() < 7)
+	{
+	  std::cerr << "ERROR: recur command takes at least 6 arguments.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //Read the schedule
+      Recurrence::Period period;
+      if (!Recurrence::parsePeriod(tokens[4], period))
+	{
+	  std::cerr << "ERROR: Period must be daily, weekly, monthly or yearly.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      int start, end = Recurrence::NEVER;
+      if (!Recurrence::parseDate(tokens[5], start))
+	{
+	  std::cerr << "ERROR: Start date must be written YYYY-MM-DD.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      size_t first = 6;
+      if (tokens[6] == "until")
+	{
+	  if (tokens.size() < 9 || !Recurrence::parseDate(tokens[7], end) || end < start)
 	    {
-	      std::cerr << "WARNING: Person name \"" << tokens[1] << "\" already in use.\n" <<
-		"Warning occurred at line " << lineNum << ".\n";
-	      taken = true;
+	      std::cerr << "ERROR: End date must be written YYYY-MM-DD, no earlier than the start, " <<
+		"and followed by who pays.\n" <<
+		"Stopped parsing at line " << lineNum << ".\n";
+	      return 1;
 	    }
-	  
-	  //Add the person and place them in the "All" group
-	  if (!taken) all->addPerson(tokens[1]);
-	  persons.push_back(Person(tokens[1]));
+	  first = 8;
 	}
 
-      //join command: Add people to a group
-      //join GROUPNAME PERSONNAME1 PERSONNAME2 ...
-      else if (tokens[0] == "join")
+      //Store one rule per person; occurrences are only counted when needed
+      Money amount(int((atof(tokens[2].c_str()) * 100.0) + 0.5));
+      Payees payees;
+      if (readPayees(tokens, first, payees, lineNum) != 0) return 1;
+      Ledger::Status status = ledger.addRecurring(tokens[1], amount, tokens[3], period, start, end, payees);
+      if (status != Ledger::OK) return paymentError(status, ledger, lineNum);
+    }
+
+  //debt command: Display how much one person owes another person (or overall)
+  //debt PERSONNAME1 [PERSONNAME2]
+  else if (tokens[0] == "debt")
+    {
+      //Verify input length
+      if (tokens.size() > 3)
 	{
-	  //Verify line length
-	  if (tokens.size() < 3)
+	  std::cerr << "ERROR: debt command takes no more than 2 arguments.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      else if (tokens.size() == 3)
+	{
+	  //Print the debt 1 owes 2 minus the debt 2 owes 1, ensuring both people exist
+	  Money owed;
+	  std::string missing;
+	  if (ledger.balance(tokens[1], tokens[2], owed, &missing) != Ledger::OK)
 	    {
-	      std::cerr << "ERROR: Join command must have at least two arguments.\n" <<
+	      std::cerr << "ERROR: person " << missing << " does not exist.\n" <<
 		"Stopped parsing at line " << lineNum << ".\n";
 	      return 1;
 	    }
 
-	  //Ensure the group exists
-	  groupIt g;
-	  for (g = groups.begin(); g != groups.end(); g++)
+	  std::cout << tokens[1] << " owes " << tokens[2] << " $" << float(owed.cents())/100.0 << ".\n";
+	}
+      else if (tokens.size() == 2)
+	{
+	  //Print the total debt 1 owes, ensuring the person exists
+	  Money owed;
+	  if (ledger.balance(tokens[1], owed) != Ledger::OK)
 	    {
-	      if (g->name() == tokens[1]) break;
+	      std::cerr << "ERROR: person " << tokens[1] << " does not exist.\n" <<
+		"Stopped parsing at line " << lineNum << ".\n";
+	      return 1;
 	    }
-	  if (g == groups.end())
+
+	  std::cout << tokens[1] << " owes $" << float(owed.cents())/100.0 << " total." << std::endl;
+	}
+      else
+	{
+	  std::cerr << "ERROR: debt command requires at least one argument.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+    }
+
+  //matrix command: Display what every member of a group owes every other member
+  //matrix all | group GROUPNAME [csv]
+  else if (tokens[0] == "matrix")
+    {
+      //Verify input length
+      bool csv = tokens.size() > 1 && tokens[tokens.size()-1] == "csv";
+      size_t length = csv ? tokens.size() - 1 : tokens.size();
+      if (!(length == 2 && tokens[1] == "all") && !(length == 3 && tokens[1] == "group"))
+	{
+	  std::cerr << "ERROR: matrix command takes \"all\" or \"group GROUPNAME\", then optionally \"csv\".\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //Ensure the group exists
+      std::string name = length == 2 ? "All" : tokens[2];
+      groupIt g;
+      for (g = groups.begin(); g != groups.end(); g++)
+	{
+	  if (g->name() == name) break;
+	}
+      if (g == groups.end())
+	{
+	  std::cerr << "ERROR: Group " << name << " does not exist.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //Build it all at once and print it out
+      DebtMatrix matrix(*g, ledger, Recurrence::today());
+      if (csv) matrix.printCSV(std::cout);
+      else matrix.printTable(std::cout);
+    }
+
+  //load command: loads from a file
+  //load FILENAME
+  else if (tokens[0] == "load")
+    {
+      //Verify input length
+      if (tokens.size() != 2)
+	{
+	  std::cerr << "ERROR: load command takes only one argument.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      
+      //Read it in, or reuse what it did last time
+      int ret = loadFile(tokens[1], ledger);
+      if (ret == 2)
+	{
+	  std::cerr << "ERROR: Could not find/open file " << tokens[1] <<
+	    "\nStopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      if (ret == 3)
+	{
+	  std::cerr << "ERROR: File " << tokens[1] << " is already being loaded.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      if (ret != 0)
+	{
+	  std::cerr << "ERROR: Failed to read file " << tokens[1] <<
+	    "\nStopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //A file loaded by hand becomes the ledger compact works on
+      if (fromTerminal) ledgerFile = tokens[1];
+
+      //Notify user
+      if (!replaying) std::cout << "Read input from " << tokens[1] << ".\n";
+    }
+
+  //compact command: rewrite the ledger as the smallest file giving the same state
+  //compact OUTFILE [before LINE]
+  else if (tokens[0] == "compact")
+    {
+      //Verify input length
+      if (tokens.size() != 2 && !(tokens.size() == 4 && tokens[2] == "before"))
+	{
+	  std::cerr << "ERROR: compact command takes an output file and optionally \"before LINE\".\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      int before = 0;
+      if (tokens.size() == 4)
+	{
+	  before = atoi(tokens[3].c_str());
+	  if (before < 1)
 	    {
-	      std::cerr << "ERROR: Group " << tokens[1] << " does not exist.\n" <<
+	      std::cerr << "ERROR: Line must be a number greater than 0.\n" <<
 		"Stopped parsing at line " << lineNum << ".\n";
 	      return 1;
 	    }
-	  
-	  //Add each person, ensuring no duplicates
-	  for (size_t i = 2; i < tokens.size(); i++)
+	  if (ledgerFile.empty())
 	    {
-	      //Ensure this person exists by querying the "All" group
-	      if (!all->hasMember(tokens[i]))
-		{
-		  std::cerr << "ERROR: Person " << tokens[i] << " does not exist.\n" <<
-		    "Stopped parsing at line " << lineNum << ".\n";
-		  return 1;
-		}
-	      
-	      g->addPerson(tokens[i]);
+	      std::cerr << "ERROR: No ledger file has been loaded to compact.\n" <<
+		"Stopped parsing at line " << lineNum << ".\n";
+	      return 1;
 	    }
 	}
 
-      //leave command: Remove people from group
-      //leave GROUPNAME PERSONNAME1 PERSONNAME2 ...
-      else if (tokens[0] == "leave")
+      //Read in the original ledger, if there is one, before anything is written
+      std::vector<std::string> original;
+      if (!ledgerFile.empty())
 	{
-	  //Verify line length
-	  if (tokens.size() < 3)
+	  std::ifstream fin(ledgerFile.c_str(), std::ifstream::in);
+	  if (!fin)
 	    {
-	      std::cerr << "ERROR: Leave command must have at least two arguments.\n" <<
+	      std::cerr << "ERROR: Could not find/open file " << ledgerFile <<
+		"\nStopped parsing at line " << lineNum << ".\n";
+	      return 1;
+	    }
+	  std::string line;
+	  while (std::getline(fin, line)) original.push_back(line);
+	}
+      if (before > int(original.size()) + 1)
+	{
+	  std::cerr << "ERROR: " << ledgerFile << " only has " << original.size() << " lines.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //With a cutoff, rebuild the state as of that line; otherwise use the current state
+      Ledger old;
+      const Ledger * from = &ledger;
+      size_t kept = original.size();
+      if (before > 0)
+	{
+	  std::stringstream prefix;
+	  for (int i = 0; i < before - 1; i++) prefix << original[i] << '\n';
+
+	  replaying = true;
+	  int failed = parseInput(prefix, old);
+	  replaying = false;
+	  if (failed != 0)
+	    {
+	      std::cerr << "ERROR: Could not replay " << ledgerFile << " before line " << before << ".\n" <<
 		"Stopped parsing at line " << lineNum << ".\n";
 	      return 1;
 	    }
+	  from = &old;
+	  kept = before - 1;
+	}
 
-	  //Ensure the group exists
-	  groupIt g;
-	  for (g = groups.begin(); g != groups.end(); g++)
+      //Keep the original next to the new file
+      std::string archive = tokens[1] + ".archive";
+      if (!ledgerFile.empty())
+	{
+	  std::ofstream fout(archive.c_str(), std::ofstream::out);
+	  for (size_t i = 0; i < original.size(); i++) fout << original[i] << '\n';
+	  if (!fout)
 	    {
-	      if (g->name() == tokens[1]) break;
+	      std::cerr << "ERROR: Could not write file " << archive <<
+		"\nStopped parsing at line " << lineNum << ".\n";
+	      return 1;
 	    }
-	  if (g == groups.end())
+	}
+
+      //Write out the new ledger: declarations, balances, then the recent lines as they were
+      std::ofstream fout(tokens[1].c_str(), std::ofstream::out);
+      if (!fout)
+	{
+	  std::cerr << "ERROR: Could not write file " << tokens[1] <<
+	    "\nStopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      fout << "% Compacted from " << (ledgerFile.empty() ? "the terminal" : ledgerFile) << '\n';
+      int balances = writeCompacted(fout, *from);
+      if (before > 0)
+	{
+	  fout << "% Lines from " << before << " on are kept as they were\n";
+	  for (size_t i = kept; i < original.size(); i++) fout << original[i] << '\n';
+	}
+      fout.close();
+
+      //Notify user
+      std::cout << "Compacted " << kept << " lines into " << balances << " balances in " << tokens[1] << ".\n";
+      if (!ledgerFile.empty()) std::cout << "Original archived to " << archive << ".\n";
+    }
+
+  //export command: write balances, transactions or members for other programs
+  //export csv|json FILENAME [balances|transactions|members]
+  else if (tokens[0] == "export")
+    {
+      //Verify input length
+      if (tokens.size() != 3 && tokens.size() != 4)
+	{
+	  std::cerr << "ERROR: export command takes a format, a file and optionally what to export.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      Exporter::Format format;
+      if (!Exporter::parseFormat(tokens[1], format))
+	{
+	  std::cerr << "ERROR: Format must be csv or json.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+      std::string what = tokens.size() == 4 ? tokens[3] : "balances";
+      if (what != "balances" && what != "transactions" && what != "members")
+	{
+	  std::cerr << "ERROR: Can only export balances, transactions or members.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      Writer out;
+      if (!out.open(tokens[2]))
+	{
+	  std::cerr << "ERROR: Could not write file " << tokens[2] <<
+	    "\nStopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //Rows go straight from the lists into the file
+      Exporter exporter(out, format);
+      long rows;
+      if (what == "balances") rows = exporter.balances(ledger);
+      else if (what == "transactions") rows = exporter.transactions(ledger);
+      else rows = exporter.members(groups);
+
+      if (!out.close())
+	{
+	  std::cerr << "ERROR: Could not write file " << tokens[2] <<
+	    "\nStopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //Notify user
+      std::cout << "Exported " << rows << " " << what << " rows to " << tokens[2] << ".\n";
+    }
+
+  //mem command: Display how much memory each structure is using
+  //mem
+  else if (tokens[0] == "mem")
+    {
+      //Verify input length
+      if (tokens.size() != 1)
+	{
+	  std::cerr << "ERROR: mem command takes no arguments.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //Count what each pool is holding
+      size_t members = 0;
+      size_t totals = 0;
+      for (groupIt g = groups.begin(); g != groups.end(); g++)
+	{
+	  members += g->size();
+	  totals += g->records();
+	}
+      size_t entries = 0;
+      for (personIt p = persons.begin(); p != persons.end(); p++)
+	{
+	  for (Person::Debts::const_iterator d = p->debts().begin(); d != p->debts().end(); d++) entries += d->second.size();
+	  for (Person::Recurrences::const_iterator r = p->recurrences().begin(); r != p->recurrences().end(); r++) entries += r->second.size();
+	}
+
+      const Memory & memory = ledger.memory();
+      const MemoryPool * pools[] = {&memory.persons(), &memory.groups(), &memory.membership(), &memory.totals(),
+				    &memory.histories(), &memory.descriptions()};
+      size_t objects[] = {persons.size(), groups.size(), members, totals, entries, memory.descriptionCount()};
+
+      //Print it out; in use is what the lists hold, reserved is what the pools took from the heap
+      std::cout << std::left << std::setw(14) << "Structure" << std::right << std::setw(10) << "Objects" <<
+	std::setw(12) << "In use" << std::setw(10) << "Blocks" << std::setw(12) << "Peak" << std::setw(12) << "Reserved" << '\n';
+      size_t used = 0, reserved = 0;
+      for (size_t i = 0; i < sizeof(pools)/sizeof(pools[0]); i++)
+	{
+	  std::cout << std::left << std::setw(14) << pools[i]->name() << std::right << std::setw(10) << objects[i] <<
+	    std::setw(12) << pools[i]->used().bytes() << std::setw(10) << pools[i]->used().blocks() <<
+	    std::setw(12) << pools[i]->used().peak() << std::setw(12) << pools[i]->reserved().bytes() << '\n';
+	  used += pools[i]->used().bytes();
+	  reserved += pools[i]->reserved().bytes();
+	}
+      std::cout << std::left << std::setw(14) << "total" << std::right << std::setw(22) << used <<
+	std::setw(34) << reserved << '\n';
+
+      //Names are ordinary strings wherever they are kept, so they are left out
+      std::cout << "Not counted: the text of person and group names, in the lists and as the keys of\n" <<
+	"debts, repeating payments and members." << std::endl;
+    }
+
+  //quit command: exit the program
+  //quit
+  else if (tokens[0] == "quit")
+    {
+      std::cout << "Bye!\n";
+      return 2;
+    }
+
+  //info command: Display info about one specific group or person
+  //info PERSONNAME | group GROUPNAME
+  else if (tokens[0] == "info")
+    {
+      //Verify input length
+      if (tokens.size() > 3 || tokens.size() == 1)
+	{
+	  std::cerr << "ERROR: info command takes no more than 2 arguments.\n" <<
+	    "Stopped parsing at line " << lineNum << ".\n";
+	  return 1;
+	}
+
+      //If it's requesting person info
+      else if (tokens.size() == 2)
+	{
+	  //Find him/her, who must exist
+	  const Person * p = ledger.person(tokens[1]);
+	  Money owed;
+	  if (p == NULL || ledger.balance(tokens[1], owed) != Ledger::OK)
 	    {
-	      std::cerr << "ERROR: Group " << tokens[1] << " does not exist.\n" <<
+	      std::cerr << "ERROR: Person " << tokens[1] << " does not exist.\n" <<
 		"Stopped parsing at line " << lineNum << ".\n";
 	      return 1;
 	    }
 
-	  //Remove each person!
-	  for (size_t i = 2; i < tokens.size(); i++)
+	  //Print out info
+	  std::cout << "-----Info for " << tokens[1] << "-----\n";
+	  std::cout << "Total debt: $" << float(owed.cents())/100.0 << ".\n\n";
+	  
+	  for (std::pmr::set<std::string>::const_iterator g = all->persons().begin(); g != all->persons().end(); g++)
 	    {
-	      //If the person was not in the group, error
-	      if (!g->removePerson(tokens[i]))
+	      //Skip this person
+	      if (p->name() == (*g)) continue;
+
+	      ledger.balance(tokens[1], (*g), owed);
+	      
+	      std::cout << tokens[1] << " owes " << (*g) << " $" << float(owed.cents())/100.0 << ".\n";
+	      for (Ledger::Entry e : ledger.history(tokens[1], (*g)))
+		{
+		  std::cout << "  " << e.desc << ": " << float(e.amount.cents())/100.0 << ".\n";
+		}
+	      for (Ledger::Entry e : ledger.history((*g), tokens[1]))
 		{
-		  std::cerr << "ERROR: Person " <<
-		    tokens[i] << " is not in group " << tokens[1] << ".\n" <<
-		    "Stopped parsing at line " << lineNum << ".\n";
-		  return 1;
+		  std::cout << "  " << e.desc << ": -" << float(e.amount.cents())/100.0 << ".\n";
 		}
+
+	      //Repeating payments, expanded only now
+	      for (Ledger::Entry e : ledger.occurrences(tokens[1], (*g)))
+		{
+		  std::cout << "  " << e.desc << '@' << Recurrence::formatDate(e.day) << ": " <<
+		    float(e.amount.cents())/100.0 << ".\n";
+		}
+	      for (Ledger::Entry e : ledger.occurrences((*g), tokens[1]))
+		{
+		  std::cout << "  " << e.desc << '@' << Recurrence::formatDate(e.day) << ": -" <<
+		    float(e.amount.cents())/100.0 << ".\n";
+		}
+
+	      std::cout << std::endl;
 	    }
 	}
-
-      //groupdel command: Delete a group
-      //groupdel GROUPNAME
-      else if (tokens[0] == "groupdel")
+      else //tokens.size() == 3
 	{
-	  //Verify line length
-	  if (tokens.size() != 2)
+	  if (tokens[1] != "group")
 	    {
-	      std::cerr << "ERROR: Groupdel command only takes one argument.\n" <<
+	      std::cerr << "ERROR: Expected \"group\" but found \"" << tokens[1] << "\".\n" <<
 		"Stopped parsing at line " << lineNum << ".\n";
 	      return 1;
 	    }
 
-	  //Ensure this group exists
+	  //The group must exist
 	  groupIt g;
 	  for (g = groups.begin(); g != groups.end(); g++)
 	    {
-	      if (g->name() == tokens[1]) break;
+	      if (g->name() == tokens[2]) break;
 	    }
 	  if (g == groups.end())
 	    {
-	      std::cerr << "ERROR: Group " << tokens[1]<<" already does not exist.\n" <<
+	      std::cerr << "ERROR: Group " << tokens[2] << " does not exist.\n" <<
 		"Stopped parsing at line " << lineNum << ".\n";
 	      return 1;
 	    }
 
-	  //Delete it
-	  groups.erase(g);
+	  //Print out info, all of it kept up to date as the group was used
+	  int today = Recurrence::today();
+	  std::cout << "-----Info for group " << tokens[2] << "-----\n";
+	  std::cout << "Total spent: $" << float(g->spent(today))/100.0 << ".\n\n";
+
+	  std::cout << "Members (" << g->size() << "), and how much each has put in beyond their share:\n";
+	  for (std::pmr::set<std::string>::const_iterator i = g->persons().begin(); i != g->persons().end(); i++)
+	    {
+	      std::cout << "  " << (*i) << ": " << float(g->net((*i), today))/100.0 << ".\n";
+	    }
+
+	  //Former members and anyone else who paid for the group
+	  std::set<std::string> involved = g->involved();
+	  bool header = false;
+	  for (std::set<std::string>::const_iterator i = involved.begin(); i != involved.end(); i++)
+	    {
+	      if (g->hasMember((*i))) continue;
+	      if (!header) std::cout << "Others:\n";
+	      header = true;
+	      std::cout << "  " << (*i) << ": " << float(g->net((*i), today))/100.0 << ".\n";
+	    }
+
+	  std::cout << "\nMembership history:\n";
+	  for (std::pmr::list<std::pair<std::string,bool> >::const_iterator i = g->membership().begin();
+	       i != g->membership().end(); i++)
+	    {
+	      std::cout << "  " << i->first << (i->second ? " joined" : " left") << ".\n";
+	    }
+	  std::cout << std::endl;
+	}
+    }
+
+  //Help command
+  else if(tokens[0] == "help")
+    {
+      //If no arguments
+      if (tokens.size() == 1)
+	{
+	  std::cout << "Available commands: person group join leave groupdel persondel tx recur debt info matrix load compact export mem quit\n";
 	}
-      
-      //persondel command: Delete a person, also removing their debt
-      //persondel PERSONNAME
-      else if (tokens[0] == "persondel")
+      else //Two or more arguments
 	{
-	  //Verify line length
-	  if (tokens.size() != 2)
+	  if (tokens[1] == "person")
 	    {
-	      std::cerr << "ERROR: Persondel command only takes one argument.\n" <<
-		"Stopped parsing at line " << lineNum << ".\n";
-	      return 1;
+	      std::cout << "Adds a person.\nperson PERSONNAME\n";
 	    }
-	  
-	  //Ensure this person exists
-	  if (!all->hasMember(tokens[1]))
+	  else if (tokens[1] == "group")
 	    {
-	      std::cerr << "ERROR: Person " << tokens[1] << " already does not exist.\n" <<
-		"Stopped parsing at line " << lineNum << ".\n";
-	      return 1;
+	      std::cout << "Adds a group.\ngroup GROUPNAME\n";
 	    }
-	  
-	  //Remove this person from all groups
-	  for (groupIt g = groups.begin(); g != groups.end(); g++)
+	  else if (tokens[1] == "join")
 	    {
-	      g->removePerson(tokens[1]);
+	      std::cout << "Adds a person to a group.\njoin GROUPNAME PERSONNAME1 [PERSONNAME2 ...]\n";
 	    }
-
-	  personIt p;
-	  for (p = persons.begin(); p != persons.end(); p++)
+	  else if (tokens[1] == "leave")
 	    {
-	      if (p->name() == tokens[1]) break;
+	      std::cout << "Removes a person from a group.\nleave GROUPNAME PERSONNAME1 [PERSONNAME2 ...]\n";
 	    }
-	  persons.erase(p);
-	}
-      
-      //tx command: Record a transaction between persons
-      //tx PAYER AMOUNT CATEGORY PERSONNAME1 group GROUPNAME1 PERSONNAME2
-      else if (tokens[0] == "tx")
-	{
-	  //Verify line length
-	  if (tokens.size() < 5)
+	  else if (tokens[1] == "groupdel")
 	    {
-	      std::cerr << "ERROR: tx command takes at least 5 arguments.\n" <<
-		"Stopped parsing at line " << lineNum << ".\n";
-	      return 1;
+	      std::cout << "Removes a group.\ngroupdel GROUPNAME\n";
 	    }
-
-	  //Ensure payer exists
-	  if (!all->hasMember(tokens[1]))
+	  else if (tokens[1] == "persondel")
 	    {
-	      std::cerr << "ERROR: Person " << tokens[1] << " does not exist.\n" <<
-		"Stopped parsing at line " << lineNum << ".\n";
-	      return 1;
+	      std::cout << "Removes a person and erases all their debt.\npersondel PERSONNAME\n";
 	    }
-
-	  //Ensure the amount is a number
-	  int amount = (atof(tokens[2].c_str()) * 100.0) + 0.5;
-	  if (amount == 0)
+	  else if (tokens[1] == "tx")
 	    {
-	      std::cerr << "ERROR: Amount must be a number greater than 0.\n" <<
-		"Stopped parsing at line " << lineNum << ".\n";
-	      return 1;
+	      std::cout << "Creates a transaction.\ntx PERSONNAME AMOUNT DESCRIPTION PERSONNAME1 [PERSONNAME2 ...]\n";
 	    }
-
-	  //Find the amount each person will spend
-	  std::set<std::string> spenders;
-	  
-	  //Go through every other person
-	  //Do a verification and counting run
-	  for (size_t i = 4; i < tokens.size(); i++)
+	  else if (tokens[1] == "recur")
 	    {
-	      //If it is a group
-	      if (tokens[i] == "group")
-		{
-		  //Ensure the group exists
-		  i++;
-		  if (i == tokens.size())
-		    {
-		      std::cerr << "ERROR: No group specified.\n" <<
-			"Stopped parsing at line " << lineNum << ".\n";
-		      return 1;
-		    }
-		  
-		  //Ensure the group exists
-		  groupIt g;
-		  for (g = groups.begin(); g != groups.end(); g++)
-		    {
-		      if (g->name() == tokens[i]) break;
-		    }
-		  
-		  if (g == groups.end())
-		    {
-		      std::cerr << "ERROR: Group " << tokens[i] << " does not exist.\n" <<
-			"Stopped parsing at line " << lineNum << ".\n";
-		      return 1;
-		    }
-		  
-		  //Add these people to the set
-		  spenders.insert(g->persons().begin(), g->persons().end());
-		  continue;
-		}
-	      
-	      //Ensure they exist
-	      if (!all->hasMember(tokens[i]))
-		{
-		  std::cerr << "ERROR: Person " << tokens[i] << " does not exist.\n" <<
-		    "Stopped parsing at line" << lineNum << ".\n";
-		  return 1;
-		}
-	      
-	      //Add this person to the set
-	      spenders.insert(tokens[i]);
+	      std::cout << "Creates a transaction repeating daily, weekly, monthly or yearly from START (YYYY-MM-DD).\n" <<
+		"recur PERSONNAME AMOUNT DESCRIPTION PERIOD START [until END] PERSONNAME1 [PERSONNAME2 ...]\n";
 	    }
-	  
-	  //See how much each person pays
-	  //If the person who spent the money is also paying
-	  unsigned int numSpenders;
-	  if (spenders.find(tokens[1]) != spenders.end())
+	  else if (tokens[1] == "debt")
 	    {
-	      numSpenders = spenders.size();
+	      std::cout << "Displays a person's debt overall, or just to one person.\ndebt PERSONNAME1 [PERSONNAME2]\n";
 	    }
-	  else
+	  else if (tokens[1] == "info")
 	    {
-	      numSpenders = spenders.size();
+	      std::cout << "Displays information about a person, or about a group: what has been spent through it,\n" <<
+		"how much each member has put in beyond their share, and who joined and left.\n" <<
+		"info PERSONNAME | group GROUPNAME\n";
 	    }
-	  
-	  int perPerson = amount/numSpenders;
-	  
-	  //Go over each person, add this debt
-	  for (std::set<std::string>::iterator i = spenders.begin(); i != spenders.end(); i++)
+	  else if (tokens[1] == "matrix")
 	    {
-	      //Check for payer
-	      if ((*i) == tokens[1])
-		{
-		  if (numSpenders != spenders.size()) continue;
-		}
-	      
-	      //Add it!
-	      personIt p;
-	      for (p = persons.begin(); p != persons.end(); p++)
-		{
-		  if (p->name() == (*i)) break;
-		}
-	      p->addDebt(tokens[1], perPerson, tokens[3]);
+	      std::cout << "Displays what each member of a group owes each other member, as a table or CSV.\n" <<
+		"matrix all | group GROUPNAME [csv]\n";
 	    }
-	}
-
-      //debt command: Display how much one person owes another person (or overall)
-      //debt PERSONNAME1 [PERSONNAME2]
-      else if (tokens[0] == "debt")
-	{
-	  //Verify input length
-	  if (tokens.size() > 3)
+	  else if (tokens[1] == "load")
 	    {
-	      std::cerr << "ERROR: debt command takes no more than 2 arguments.\n" <<
-		"Stopped parsing at line " << lineNum << ".\n";
-	      return 1;
+	      std::cout << "Loads from a file.\nload FILENAME\n";
 	    }
-	  else if (tokens.size() == 3)
+	  else if (tokens[1] == "compact")
 	    {
-	      //Ensure both people exist
-	      if (!all->hasMember(tokens[1]))
-		{
-		  std::cerr << "ERROR: person " << tokens[1] << " does not exist.\n" <<
-		    "Stopped parsing at line " << lineNum << ".\n";
-		  return 1;
-		}
-	      if (!all->hasMember(tokens[2]))
-		{
-		  std::cerr << "ERROR: person " << tokens[2] << " does not exist.\n" <<
-		    "Stopped parsing at line " << lineNum << ".\n";
-		  return 1;
-		}
-
-	      //Print the debt 1 owes 2 minus the debt 2 owes 1
-	      personIt p1, p2;
-	      for (p1 = persons.begin(); p1 != persons.end(); p1++)
-		{
-		  if (tokens[1] == p1->name()) break;
-		}
-	      for (p2 = persons.begin(); p2 != persons.end(); p2++)
-		{
-		  if (tokens[2] == p2->name()) break;
-		}
-
-	      float total = float(p1->debt(p2->name()))/100.0 - float(p2->debt(p1->name()))/100.0;
-
-	      std::cout << tokens[1] << " owes " << tokens[2] << " $" << total << ".\n";
+	      std::cout << "Writes a smaller ledger giving the same balances, archiving the original.\n" <<
+		"Lines before LINE of the loaded ledger are replaced; later lines are kept as they are.\n" <<
+		"compact OUTFILE [before LINE]\n";
 	    }
-	  else if (tokens.size() == 2)
+	  else if (tokens[1] == "export")
 	    {
-	      //Ensure the person exists
-	      if (!all->hasMember(tokens[1]))
-		{
-		  std::cerr << "ERROR: person " << tokens[1] << " does not exist.\n" <<
-		    "Stopped parsing at line " << lineNum << ".\n";
-		  return 1;
-		}
-
-	      //Print the total debt 1 owes
-	      personIt p1;
-	      for (p1 = persons.begin(); p1 != persons.end(); p1++)
-		{
-		  if (tokens[1] == p1->name()) break;
-		}
-
-	      float total = float(p1->totalDebt())/100.0 - float(debtTo(persons, tokens[1]))/100.0;
-
-	      std::cout << tokens[1] << " owes $" << total << " total." << std::endl;
+	      std::cout << "Writes balances (the default), transactions or group members to a CSV or JSON file.\n" <<
+		"export csv|json FILENAME [balances|transactions|members]\n";
+	    }
+	  else if (tokens[1] == "mem")
+	    {
+	      std::cout << "Displays the objects and bytes held by each structure, apart from the text of names.\nmem\n";
+	    }
+	  else if (tokens[1] == "quit")
+	    {
+	      std::cout << "Exits the program.\n";
+	    }
+	  else if (tokens[1] == "help")
+	    {
+	      std::cout << "Prints *this.\n";
 	    }
 	  else
 	    {
-	      std::cerr << "ERROR: debt command requires at least one argument.\n" <<
-		"Stopped parsing at line " << lineNum << ".\n";
-	      return 1;
+	      std::cerr << "WARNING: Command \"" << tokens[1] << "\" does not exist.\n" <<
+		"Warning occurred at line " << lineNum << ".\n";
 	    }
 	}
+    }
 
-      //load command: loads from a file
-      //load FILENAME
-      else if (tokens[0] == "load")
-        {
-          //Verify input length
-	  if (tokens.size() != 2)
-	    {
-	      std::cerr << "ERROR: load command takes only one argument.\n" <<
-		"Stopped parsing at line " << lineNum << ".\n";
-	      return 1;
-	    }
-          
-          //Make sure this is a file we can use
-          std::ifstream fin(tokens[1].c_str(), std::ifstream::in);
-          if (!fin)
-            {
-              std::cerr << "ERROR: Could not find/open file " << tokens[1] <<
-                "\nStopped parsing at line " << lineNum << ".\n";
-              return 1;
-            }
+  //Unrecognized command
+  else
+    {
+      std::cerr << "Unrecognized command " << tokens[0] << ".\n" <<
+	"Stopped parsing at line " << lineNum << ".\n";
+      return 1;
+    }
 
-          //Read it in
-          if (parseInput(fin, groups, persons) != 0)
-            {
-              std::cerr << "ERROR: Failed to read file " << tokens[1] <<
-                "\nStopped parsing at line " << lineNum << ".\n";
-              fin.close();
-              return 1;
-            }
+  return 0;
+}
 
-          //Close it up
-          fin.close();
+//Takes a given input stream and parses it, modifying the provided lists
+//Reads until EOF is found. This will assume an "All" group already exists.
+//Returns 0 if it succeeded, returns 1 otherwise.
+int parseInput(std::istream & input, Ledger & ledger)
+{
+  //Set up some variables
+  int lineNum = 0;
+  std::string line;
+  std::vector<std::string> tokens;
 
-          //Notify user
-          std::cout << "Read input from " << tokens[1] << ".\n";
-        }
+  //Read until EOF
+  while (true)
+    {
+      //If reading from terminal, place a prompt
+      if (&input == &std::cin) std::cout << "> ";
 
-      //quit command: exit the program
-      //quit
-      else if (tokens[0] == "quit")
-	{
-	  std::cout << "Bye!\n";
-	  return 0;
-	}
+      //Get lines one at a time
+      if (!std::getline(input, line)) break;
+      lineNum++;
 
-      //info command: Display info about one specific group or person
-      //info PERSONNAME | group GROUPNAME
-      else if (tokens[0] == "info")
-	{
-	  //Verify input length
-	  if (tokens.size() > 3 || tokens.size() == 1)
-	    {
-	      std::cerr << "ERROR: info command takes no more than 2 arguments.\n" <<
-		"Stopped parsing at line " << lineNum << ".\n";
-	      return 1;
-	    }
+      //Now parse the individual line
+      tokenize(line, tokens);
 
-	  //If it's requesting person info
-	  else if (tokens.size() == 2)
-	    {
-	      //The person must exist
-	      if (!all->hasMember(tokens[1]))
-		{
-		  std::cerr << "ERROR: Person " << tokens[1] << " does not exist.\n" <<
-		    "Stopped parsing at line " << lineNum << ".\n";
-		  return 1;
-		}
+      //Empty line
+      if (tokens.size() == 0) continue;
 
-	      //Find him/her
-	      personIt p;
-	      for (p = persons.begin(); p != persons.end(); p++)
-		{
-		  if (p->name() == tokens[1]) break;
-		}
+      //Run it, stopping at an error or a quit
+      int ret = runCommand(tokens, lineNum, &input == &std::cin, ledger);
+      if (ret == 1) return 1;
+      if (ret == 2) return 0;
+    }
 
-	      //Print out info
-	      std::cout << "-----Info for " << tokens[1] << "-----\n";
-	      std::cout << "Total debt: $" <<
-		float(p->totalDebt())/100.0 - float(debtTo(persons, tokens[1]))/100.0 << ".\n\n";
-	      
-	      for (std::set<std::string>::const_iterator g = all->persons().begin(); g != all->persons().end(); g++)
-		{
-		  //Skip this person
-		  if (p->name() == (*g)) continue;
-
-		  personIt p2;
-		  for (p2 = persons.begin(); p2 != persons.end(); p2++)
-		    {
-		      if (p2->name() == (*g)) break;
-		    }
-
-		  float total = float(p->debt(p2->name()))/100.0 - float(p2->debt(p->name()))/100.0;
-		  
-		  std::cout << tokens[1] << " owes " << (*g) << " $" << total << ".\n";
-		  for (std::list<std::pair<std::string,int> >::const_iterator i = p->history((*g)).begin(); i != p->history((*g)).end(); i++)
-		    {
-		      float theTotal = float(i->second)/100.0;
-		      std::cout << "  " << i->first << ": " << theTotal << ".\n";
-		    }
-                  for (std::list<std::pair<std::string,int> >::const_iterator i = p2->history((tokens[1])).begin(); i != p2->history((tokens[1])).end(); i++)
-		    {
-		      float theTotal = float(i->second)/100.0;
-		      std::cout << "  " << i->first << ": -" << theTotal << ".\n";
-		    }
-
-		  std::cout << std::endl;
-		}
-	    }
-	  else //tokens.size() == 3
-	    {
-	      //FILL IN HERE
-	    }
-	}
-
-      //Help command
-      else if(tokens[0] == "help")
-        {
-          //If no arguments
-          if (tokens.size() == 1)
-            {
-              std::cout << "Available commands: person group join leave groupdel persondel tx debt info load quit\n";
-            }
-          else //Two or more arguments
-            {
-              if (tokens[1] == "person")
-                {
-                  std::cout << "Adds a person.\nperson PERSONNAME\n";
-                }
-              else if (tokens[1] == "group")
-                {
-                  std::cout << "Adds a group.\ngroup GROUPNAME\n";
-                }
-              else if (tokens[1] == "join")
-                {
-                  std::cout << "Adds a person to a group.\njoin GROUPNAME PERSONNAME1 [PERSONNAME2 ...]\n";
-                }
-              else if (tokens[1] == "leave")
-                {
-                  std::cout << "Removes a person from a group.\nleave GROUPNAME PERSONNAME1 [PERSONNAME2 ...]\n";
-                }
-              else if (tokens[1] == "groupdel")
-                {
-                  std::cout << "Removes a group.\ngroupdel GROUPNAME\n";
-                }
-              else if (tokens[1] == "persondel")
-                {
-                  std::cout << "Removes a person and erases all their debt.\npersondel PERSONNAME\n";
-                }
-              else if (tokens[1] == "tx")
-                {
-                  std::cout << "Creates a transaction.\ntx PERSONNAME AMOUNT DESCRIPTION PERSONNAME1 [PERSONNAME2 ...]\n";
-                }
-              else if (tokens[1] == "debt")
-                {
-                  std::cout << "Displays a person's debt overall, or just to one person.\ndebt PERSONNAME1 [PERSONNAME2]\n";
-                }
-              else if (tokens[1] == "info")
-                {
-                  std::cout << "Displays information about a person.\ninfo PERSONNAME\n";
-                }
-              else if (tokens[1] == "load")
-                {
-                  std::cout << "Loads from a file.\nload FILENAME\n";
-                }
-              else if (tokens[1] == "quit")
-                {
-                  std::cout << "Exits the program.\n";
-                }
-              else if (tokens[1] == "help")
-                {
-                  std::cout << "Prints *this.\n";
-                }
-              else
-                {
-                  std::cerr << "WARNING: Command \"" << tokens[1] << "\" does not exist.\n" <<
-                    "Warning occurred at line " << lineNum << ".\n";
-                }
-            }
-        }
-
-      //Unrecognized command
-      else
+  return 0;
+}
+
+//Runs commands piped in rather than typed, reading and splitting them into
+//tokens on another thread while earlier ones run. Unlike typed input, an error
+//does not start the line count over.
+//Returns 0 once the input ends or a quit is seen.
+int parsePiped(FILE * input, Ledger & ledger)
+{
+  LineReader reader(input);
+  LineBatch batch;
+  int lineNum = 0;
+  while (reader.next(batch))
+    {
+      for (size_t i = 0; i < batch.lines.size(); i++)
 	{
-	  std::cerr << "Unrecognized command " << tokens[0] << ".\n" <<
-	    "Stopped parsing at line " << lineNum << ".\n";
-	  return 1;
+	  //Place a prompt for every line, as if it had been typed, empty ones included
+	  for (; lineNum < batch.lines[i].number; lineNum++) std::cout << "> ";
+
+	  //Run it, stopping only at a quit
+	  if (runCommand(batch.lines[i].tokens, lineNum, true, ledger) == 2) return 0;
 	}
-	      
+      for (; lineNum < batch.total; lineNum++) std::cout << "> ";
     }
 
+  //The prompt that found the end of the input
+  std::cout << "> ";
   return 0;
 }
 
@@ -679,34 +1090,38 @@ int parseInput(std::istream & input, std::list<Group> & groups, std::list<Person
 int main(int argc, char* argv[])
 {
   //Check input
-  if (argc > 2)
+  if (argc > 3 || (argc == 3 && std::string(argv[1]) != "--check"))
     {
-      std::cerr << "Usage: " << argv[0] << " [Transaction File]\n";
+      std::cerr << "Usage: " << argv[0] << " [Transaction File]\n" <<
+	"       " << argv[0] << " --check Transaction File\n";
       return 1;
     }
 
-  //Set up initial structures
-  //Set up one initial group for all Persons
-  std::list<Group> groups;
-  groups.push_back(Group("All"));
-  std::list<Person> persons;
+  //Check mode: validate the whole file without building any debt
+  if (argc == 3)
+    {
+      Checker checker;
+      checker.checkFile(argv[2]);
+      checker.report(std::cerr);
+      std::cout << argv[2] << ": " << checker.errors() << " error(s), " <<
+	checker.warnings() << " warning(s).\n";
+      return checker.errors() == 0 ? 0 : 1;
+    }
+
+  //Set up the ledger, which starts with one group for all Persons
+  Ledger ledger;
 
   //Check for input file
   if (argc == 2)
     {
-      //Make sure this is a file we can use
-      std::ifstream fin(argv[1], std::ifstream::in);
-      if (!fin)
+      //Read it in
+      int ret = loadFile(argv[1], ledger);
+      if (ret == 2)
 	{
 	  std::cerr << "Could not find/open file " << argv[1] << "\n";
 	  return 1;
 	}
-
-      //Read it in
-      parseInput(fin, groups, persons);
-
-      //Close it up
-      fin.close();
+      ledgerFile = argv[1];
 
       //Notify user
       std::cout << "Read input from " << argv[1] << ".\n";
@@ -715,6 +1130,7 @@ int main(int argc, char* argv[])
   //Pass input off to stdin
   std::cout << "House Money Tracker\n" <<
     "Type \"quit\" to end the program." << std::endl;
+  if (!isTerminal(stdin)) return parsePiped(stdin, ledger);
   int ret = 1;
-  while (ret != 0) ret = parseInput(std::cin, groups, persons);
+  while (ret != 0) ret = parseInput(std::cin, ledger);
 }
@@ -11,15 +11,27 @@
 
 #include "person.h"
 
-//Standard use constructor
-Person::Person(std::string inname) : name_(inname) {}
+//Standard use constructor, allocating from the given ledger's history pool
+Person::Person(std::string inname, Memory & inmemory) :
+  name_(inname), debt_(inmemory.histories().resource()), recur_(inmemory.histories().resource()),
+  memory_(&inmemory) {}
 
-//Returns the total debt this person owes to another person
-int Person::debt(std::string payer)
+//Returns the total debt this person owes to another person, as of today
+int Person::debt(const std::string & payer) const
 {
+  return historyDebt(payer) + recurringDebt(payer, Recurrence::today());
+}
+
+//Returns the debt this person owes to another person from recorded payments only
+int Person::historyDebt(const std::string & payer) const
+{
+  //Nothing owed if they have never paid for this person
+  Debts::const_iterator d = debt_.find(payer);
+  if (d == debt_.end()) return 0;
+
   //Iterate over all previous payments, sum them up
   int sum = 0;
-  for (std::list<std::pair<std::string,int> >::iterator i = debt_[payer].begin(); i != debt_[payer].end(); i++)
+  for (History::const_iterator i = d->second.begin(); i != d->second.end(); i++)
     {
       sum += i->second;
     }
@@ -27,24 +39,61 @@ int Person::debt(std::string payer)
   return sum;
 }
 
+//Returns the debt this person owes to another person from repeating payments up to a day
+int Person::recurringDebt(const std::string & payer, int day) const
+{
+  Recurrences::const_iterator r = recur_.find(payer);
+  if (r == recur_.end()) return 0;
+
+  int sum = 0;
+  for (std::pmr::list<Recurrence>::const_iterator i = r->second.begin(); i != r->second.end(); i++)
+    {
+      sum += i->owed(day);
+    }
+
+  return sum;
+}
+
+//Returns the payments another person has made for this person
+const Person::History & Person::history(const std::string & payer) const
+{
+  static const History none;
+  Debts::const_iterator d = debt_.find(payer);
+  return d == debt_.end() ? none : d->second;
+}
+
 //Adds some debt this person must pay
-void Person::addDebt(std::string payer, int amount, std::string desc)
+//The description is shared with every other payment using the same one
+void Person::addDebt(std::string payer, int amount, const std::string & desc)
 {
-  debt_[payer].push_back(make_pair(desc, amount));
+  debt_[payer].emplace_back(memory_->intern(desc), amount);
+}
+
+//Adds a repeating payment another person makes for this person
+void Person::addRecurrence(std::string payer, const Recurrence & rule)
+{
+  recur_[payer].push_back(rule);
 }
 
 //Returns the sum of this person's debt to everyone
-int Person::totalDebt()
+int Person::totalDebt() const
 {
   //Iterate over EVERYTHING, sum up
   int sum = 0;
-  for (std::map<std::string, std::list<std::pair<std::string,int> > >::iterator i = debt_.begin(); i != debt_.end(); i++)
+  for (Debts::const_iterator i = debt_.begin(); i != debt_.end(); i++)
     {
-      for (std::list<std::pair<std::string,int> >::iterator j = i->second.begin(); j != i->second.end(); j++)
+      for (History::const_iterator j = i->second.begin(); j != i->second.end(); j++)
 	{
 	  sum += j->second;
 	}
     }
 
+  //Plus every repeating payment so far
+  int day = Recurrence::today();
+  for (Recurrences::const_iterator i = recur_.begin(); i != recur_.end(); i++)
+    {
+      sum += recurringDebt(i->first, day);
+    }
+
   return sum;
 }
@@ -13,33 +13,62 @@
 #define _person_h_
 
 #include <string>
+#include <string_view>
 #include <map>
 #include <list>
+#include <memory_resource>
+#include "memory.h"
+#include "recurrence.h"
 
 class Person
 {
  public:
+  //A list of payments: what each was for, and how much was owed
+  typedef std::pmr::list<std::pair<std::string_view,int> > History;
+  typedef std::pmr::map<std::string, History> Debts;
+  typedef std::pmr::map<std::string, std::pmr::list<Recurrence> > Recurrences;
+
   //Constructors
-  Person(std::string inname);
+  Person(std::string inname, Memory & inmemory);
 
   //Accessors
   const std::string & name() const {return name_;}
-  int debt(std::string payer);
-  const std::list<std::pair<std::string,int> > & history(std::string payer) {return debt_[payer];}
+  int debt(const std::string & payer) const;
+  int historyDebt(const std::string & payer) const;
+  int recurringDebt(const std::string & payer, int day) const;
+  const History & history(const std::string & payer) const;
+  const Debts & debts() const {return debt_;}
+  const Recurrences & recurrences() const {return recur_;}
 
   //Mutators
   void setName(std::string inname) {name_ = inname;}
 
   //General use functions
-  void addDebt(std::string payer, int amount, std::string desc);
-  int totalDebt();
+  void addDebt(std::string payer, int amount, const std::string & desc);
+  void addRecurrence(std::string payer, const Recurrence & rule);
+  int totalDebt() const;
 
  private:
+  //Not copyable, since each person only lives in their ledger's person list
+  Person(const Person &);
+  Person & operator=(const Person &);
+
   //The person's name
   std::string name_;
 
   //A map of other people's names, and the unresolved tx history with them
-  std::map<std::string, std::list<std::pair<std::string,int> > > debt_;
+  //Both maps and their lists live in the history pool
+  Debts debt_;
+
+  //A map of other people's names, and the repeating payments they make for this person
+  //These are only expanded into individual payments when asked for
+  Recurrences recur_;
+
+  //The pools of the ledger this person is in, which also store descriptions
+  Memory * memory_;
 };
 
+//Every person, kept in the person pool
+typedef std::pmr::list<Person> PersonList;
+
 #endif
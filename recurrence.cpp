@@ -0,0 +1,172 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Recurrence Implementation File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the implementation for a class describing a payment which repeats on
+  a fixed schedule, such as rent.
+*/
+
+#include "recurrence.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+//Converts a calendar date to days since 1970-01-01
+static int daysFromCivil(int y, int m, int d)
+{
+  y -= m <= 2;
+  int era = (y >= 0 ? y : y - 399) / 400;
+  int yoe = y - era * 400;
+  int doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+//Converts days since 1970-01-01 back to a calendar date
+static void civilFromDays(int z, int & y, int & m, int & d)
+{
+  z += 719468;
+  int era = (z >= 0 ? z : z - 146096) / 146097;
+  int doe = z - era * 146097;
+  int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = yoe + era * 400 + (m <= 2);
+}
+
+//Returns the number of days in the given month
+static int daysInMonth(int y, int m)
+{
+  static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  if (m == 2 && y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)) return 29;
+  return days[m - 1];
+}
+
+//Moves a date forward by some months, keeping its day where the month allows
+static int addMonths(int day, int months)
+{
+  int y, m, d;
+  civilFromDays(day, y, m, d);
+  int index = y * 12 + (m - 1) + months;
+  y = index / 12;
+  m = index % 12 + 1;
+  if (d > daysInMonth(y, m)) d = daysInMonth(y, m);
+  return daysFromCivil(y, m, d);
+}
+
+//Standard use constructor
+Recurrence::Recurrence(std::string_view indesc, int inamount, Period inperiod, int instart, int inend) :
+  desc_(indesc), amount_(inamount), period_(inperiod), start_(instart), end_(inend) {}
+
+//Returns how many times the payment has happened on or before the given day
+//Worked out directly from the schedule, without visiting each occurrence
+int Recurrence::count(int day) const
+{
+  int limit = day < end_ ? day : end_;
+  if (limit < start_) return 0;
+
+  switch (period_)
+    {
+    case DAILY:
+      return limit - start_ + 1;
+    case WEEKLY:
+      return (limit - start_) / 7 + 1;
+    default:
+      {
+	//Count whole months, then step back if the last one is still to come
+	int sy, sm, sd, ly, lm, ld;
+	civilFromDays(start_, sy, sm, sd);
+	civilFromDays(limit, ly, lm, ld);
+	int steps = (ly - sy) * 12 + (lm - sm);
+	if (period_ == YEARLY) steps /= 12;
+	if (date(steps) > limit) steps--;
+	return steps + 1;
+      }
+    }
+}
+
+//Returns the day of the nth occurrence, counting from 0
+int Recurrence::date(int n) const
+{
+  switch (period_)
+    {
+    case DAILY:
+      return start_ + n;
+    case WEEKLY:
+      return start_ + 7 * n;
+    case MONTHLY:
+      return addMonths(start_, n);
+    default:
+      return addMonths(start_, 12 * n);
+    }
+}
+
+//Returns the current day, or the MT_TODAY environment variable if it is set
+int Recurrence::today()
+{
+  int day;
+  const char * fixed = getenv("MT_TODAY");
+  if (fixed != NULL && parseDate(fixed, day)) return day;
+
+  //localtime shares its result between threads, so each call gets its own
+  time_t now = time(NULL);
+  struct tm local;
+#ifdef _WIN32
+  localtime_s(&local, &now);
+#else
+  localtime_r(&now, &local);
+#endif
+  return daysFromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+}
+
+//Reads a YYYY-MM-DD date, returning false if it is not a real date
+bool Recurrence::parseDate(const std::string & text, int & day)
+{
+  int y, m, d;
+  char extra;
+  if (sscanf(text.c_str(), "%d-%d-%d%c", &y, &m, &d, &extra) != 3) return false;
+  if (m < 1 || m > 12 || d < 1 || d > daysInMonth(y, m)) return false;
+  day = daysFromCivil(y, m, d);
+  return true;
+}
+
+//Writes a day as YYYY-MM-DD
+std::string Recurrence::formatDate(int day)
+{
+  int y, m, d;
+  civilFromDays(day, y, m, d);
+  char buf[16];
+  sprintf(buf, "%04d-%02d-%02d", y, m, d);
+  return buf;
+}
+
+//Splits a day into its year, month and day of the month
+void Recurrence::toCivil(int day, int & year, int & month, int & dayOfMonth)
+{
+  civilFromDays(day, year, month, dayOfMonth);
+}
+
+//Reads a period name, returning false if it is not one
+bool Recurrence::parsePeriod(const std::string & text, Period & period)
+{
+  if (text == "daily") period = DAILY;
+  else if (text == "weekly") period = WEEKLY;
+  else if (text == "monthly") period = MONTHLY;
+  else if (text == "yearly") period = YEARLY;
+  else return false;
+  return true;
+}
+
+//Returns the name parsePeriod reads for a period
+const char * Recurrence::periodName(Period period)
+{
+  static const char * names[] = {"daily", "weekly", "monthly", "yearly"};
+  return names[period];
+}
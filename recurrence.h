@@ -0,0 +1,64 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Recurrence Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the header for a class describing a payment which repeats on a
+  fixed schedule, such as rent.
+*/
+
+#ifndef _recurrence_h_
+#define _recurrence_h_
+
+#include <string>
+#include <string_view>
+
+class Recurrence
+{
+ public:
+  //How often the payment happens
+  enum Period {DAILY, WEEKLY, MONTHLY, YEARLY};
+
+  //Dates are counted in days since 1970-01-01
+  static const int NEVER = 0x7fffffff;
+
+  //Constructors
+  //The description is not copied, so it has to outlive the rule.
+  Recurrence(std::string_view indesc, int inamount, Period inperiod, int instart, int inend = NEVER);
+
+  //Accessors
+  std::string_view desc() const {return desc_;}
+  int amount() const {return amount_;}
+  Period period() const {return period_;}
+  int start() const {return start_;}
+  int end() const {return end_;}
+
+  //General use functions
+  int count(int day) const;
+  int date(int n) const;
+  int owed(int day) const {return count(day) * amount_;}
+
+  //Date helpers
+  static int today();
+  static bool parseDate(const std::string & text, int & day);
+  static std::string formatDate(int day);
+  static void toCivil(int day, int & year, int & month, int & dayOfMonth);
+  static bool parsePeriod(const std::string & text, Period & period);
+  static const char * periodName(Period period);
+
+ private:
+  //What the payment is for, kept by whoever made the rule, and how much each
+  //occurrence costs
+  std::string_view desc_;
+  int amount_;
+
+  //The schedule: the first occurrence, how often, and the last possible day
+  Period period_;
+  int start_;
+  int end_;
+};
+
+#endif
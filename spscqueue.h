@@ -0,0 +1,149 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----SPSC Queue Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains a bounded queue passing items from exactly one producer thread to
+  exactly one consumer thread without locks, only falling back on a lock to
+  sleep while it is full or empty.
+*/
+
+#ifndef _spscqueue_h_
+#define _spscqueue_h_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class SpscQueue
+{
+ public:
+  //Constructors
+  //One slot is always left empty to tell a full queue from an empty one
+  SpscQueue(size_t incapacity) : slots_(incapacity + 1), head_(0), tail_(0), waiting_(false), closed_(false) {}
+
+  //General use functions
+  //Only the producer may push, and only the consumer may pop or close
+  bool tryPush(T & item);
+  bool tryPop(T & item);
+  bool push(T & item);
+  void pop(T & item);
+  void close();
+
+ private:
+  //Not copyable, since both threads hold on to it
+  SpscQueue(const SpscQueue &);
+  SpscQueue & operator=(const SpscQueue &);
+
+  //The items, with the next one to pop at head_ and the next free slot at tail_
+  //Each index is written by one thread only, and kept apart to avoid false sharing
+  std::vector<T> slots_;
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) std::atomic<size_t> tail_;
+
+  //Wakes the other thread if it went to sleep on the lock
+  void wake();
+
+  //The other thread sleeps on these while there is nothing it can do; waiting_
+  //is set while it might be asleep, so the other side only locks when it must
+  alignas(64) std::atomic<bool> waiting_;
+  std::mutex lock_;
+  std::condition_variable changed_;
+  bool closed_;
+};
+
+//Moves an item onto the back of the queue
+//Returns false, leaving the item alone, if the queue is full
+template <typename T>
+bool SpscQueue<T>::tryPush(T & item)
+{
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  size_t next = tail + 1 == slots_.size() ? 0 : tail + 1;
+  if (next == head_.load(std::memory_order_acquire)) return false;
+
+  slots_[tail] = std::move(item);
+  tail_.store(next, std::memory_order_release);
+  return true;
+}
+
+//Moves the item at the front of the queue into item
+//Returns false if the queue is empty
+template <typename T>
+bool SpscQueue<T>::tryPop(T & item)
+{
+  size_t head = head_.load(std::memory_order_relaxed);
+  if (head == tail_.load(std::memory_order_acquire)) return false;
+
+  item = std::move(slots_[head]);
+  head_.store(head + 1 == slots_.size() ? 0 : head + 1, std::memory_order_release);
+  return true;
+}
+
+//Moves an item onto the back of the queue, sleeping while it is full
+//Returns false, leaving the item alone, if the consumer closed the queue instead
+template <typename T>
+bool SpscQueue<T>::push(T & item)
+{
+  if (!tryPush(item))
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      while (true)
+	{
+	  //Say so before looking again, so a pop from now on is sure to wake us
+	  waiting_.store(true, std::memory_order_relaxed);
+	  std::atomic_thread_fence(std::memory_order_seq_cst);
+	  if (closed_) return false;
+	  if (tryPush(item)) break;
+	  changed_.wait(lock);
+	}
+    }
+  wake();
+  return true;
+}
+
+//Moves the item at the front of the queue into item, sleeping while it is empty
+template <typename T>
+void SpscQueue<T>::pop(T & item)
+{
+  if (!tryPop(item))
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      while (true)
+	{
+	  waiting_.store(true, std::memory_order_relaxed);
+	  std::atomic_thread_fence(std::memory_order_seq_cst);
+	  if (tryPop(item)) break;
+	  changed_.wait(lock);
+	}
+    }
+  wake();
+}
+
+//Tells the producer nothing more will be popped, waking it if it is waiting to push
+template <typename T>
+void SpscQueue<T>::close()
+{
+  std::lock_guard<std::mutex> lock(lock_);
+  closed_ = true;
+  changed_.notify_all();
+}
+
+//Wakes the other thread if it may be asleep waiting for what was just done
+template <typename T>
+void SpscQueue<T>::wake()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!waiting_.load(std::memory_order_relaxed)) return;
+  std::lock_guard<std::mutex> lock(lock_);
+  waiting_.store(false, std::memory_order_relaxed);
+  changed_.notify_all();
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Writer Implementation File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the implementation for a class which writes text to a file through
+  one large buffer, formatting numbers without building strings.
+*/
+
+#include "writer.h"
+
+//Standard use constructor
+Writer::Writer(size_t insize) : file_(NULL), good_(true), buf_(insize), used_(0) {}
+
+//Writes anything left before going away
+Writer::~Writer()
+{
+  close();
+}
+
+//Opens a file for writing, replacing anything already there
+bool Writer::open(const std::string & filename)
+{
+  close();
+  file_ = fopen(filename.c_str(), "wb");
+  good_ = file_ != NULL;
+  return good_;
+}
+
+//Writes everything out and closes the file
+//Returns false if any write failed
+bool Writer::close()
+{
+  if (file_ == NULL) return good_;
+  flush();
+  if (fclose(file_) != 0) good_ = false;
+  file_ = NULL;
+  return good_;
+}
+
+//Hands the buffered text to the file
+void Writer::flush()
+{
+  if (file_ != NULL && used_ > 0 && fwrite(&buf_[0], 1, used_, file_) != used_) good_ = false;
+  used_ = 0;
+}
+
+//Appends some text, going straight to the file if it would not fit anyway
+void Writer::put(const char * text, size_t length)
+{
+  if (used_ + length > buf_.size())
+    {
+      flush();
+      if (length > buf_.size())
+	{
+	  if (file_ != NULL && fwrite(text, 1, length, file_) != length) good_ = false;
+	  return;
+	}
+    }
+  memcpy(&buf_[used_], text, length);
+  used_ += length;
+}
+
+//Appends an amount of cents as dollars, such as -12.05
+void Writer::putCents(int cents)
+{
+  unsigned long magnitude = cents;
+  if (cents < 0)
+    {
+      put('-');
+      magnitude = 0ul - (unsigned long)(long)cents;
+    }
+  putDigits(magnitude / 100, 1);
+  put('.');
+  putDigits(magnitude % 100, 2);
+}
+
+//Appends a date as YYYY-MM-DD
+void Writer::putDate(int year, int month, int day)
+{
+  putDigits(year, 4);
+  put('-');
+  putDigits(month, 2);
+  put('-');
+  putDigits(day, 2);
+}
+
+//Appends a number of digits, zero padded to at least the given width
+void Writer::putDigits(unsigned long value, int width)
+{
+  char digits[24];
+  int n = 0;
+  do
+    {
+      digits[n++] = '0' + value % 10;
+      value /= 10;
+    }
+  while (value > 0 || n < width);
+
+  if (used_ + n > buf_.size()) flush();
+  while (n > 0) buf_[used_++] = digits[--n];
+}
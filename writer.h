@@ -0,0 +1,60 @@
+/*
+  Copyright (c) 2014 Auston Sterling
+  See LICENSE for copying permissions.
+
+  -----Writer Header File-----
+  Auston Sterling
+  austonst@gmail.com
+
+  Contains the header for a class which writes text to a file through one
+  large buffer, formatting numbers without building strings.
+*/
+
+#ifndef _writer_h_
+#define _writer_h_
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Writer
+{
+ public:
+  //Constructors
+  Writer(size_t insize = 1 << 20);
+  ~Writer();
+
+  //Accessors
+  bool good() const {return file_ != NULL && good_;}
+
+  //General use functions
+  bool open(const std::string & filename);
+  bool close();
+  void flush();
+  void put(char c) {if (used_ == buf_.size()) flush(); buf_[used_++] = c;}
+  void put(const char * text, size_t length);
+  void put(const char * text) {put(text, strlen(text));}
+  void put(std::string_view text) {put(text.data(), text.size());}
+  void putCents(int cents);
+  void putDate(int year, int month, int day);
+
+ private:
+  //Not copyable, since it owns the file
+  Writer(const Writer &);
+  Writer & operator=(const Writer &);
+
+  //Appends a number of digits, zero padded to at least the given width
+  void putDigits(unsigned long value, int width);
+
+  //The file being written, and whether every write so far succeeded
+  FILE * file_;
+  bool good_;
+
+  //Text waiting to be written
+  std::vector<char> buf_;
+  size_t used_;
+};
+
+#endif